@@ -0,0 +1,215 @@
+
+#ifndef WRENCH_EXAMPLE_ASYNCWRITER_H
+#define WRENCH_EXAMPLE_ASYNCWRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace wrench {
+
+    /**
+     *  @brief A bounded lock-free queue with a single producer thread and a single consumer thread
+     */
+    template<typename T>
+    class SpscQueue {
+
+    public:
+        /**
+         * @brief Constructor
+         *
+         * @param capacity: the minimum number of items the queue can hold (rounded up to a power of 2)
+         */
+        explicit SpscQueue(size_t capacity) {
+            size_t size = 1;
+            while (size < capacity) {
+                size <<= 1;
+            }
+            this->slots.resize(size);
+            this->mask = size - 1;
+        }
+
+        /**
+         * @brief Enqueue an item (producer thread only)
+         *
+         * @param item: the item, which is moved from only if it is enqueued
+         * @return false if the queue is full
+         */
+        bool tryPush(T &item) {
+            auto tail = this->tail.load(std::memory_order_relaxed);
+            if (tail - this->head.load(std::memory_order_acquire) == this->slots.size()) {
+                return false;
+            }
+            this->slots[tail & this->mask] = std::move(item);
+            this->tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Dequeue an item (consumer thread only)
+         *
+         * @param item: where to move the item
+         * @return false if the queue is empty
+         */
+        bool tryPop(T &item) {
+            auto head = this->head.load(std::memory_order_relaxed);
+            if (head == this->tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            item = std::move(this->slots[head & this->mask]);
+            this->head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        std::vector<T> slots;
+        size_t mask;
+        alignas(64) std::atomic<size_t> head{0};
+        alignas(64) std::atomic<size_t> tail{0};
+    };
+
+    /**
+     *  @brief A buffered output file, optionally zstd-compressed (one frame per file)
+     */
+    class OutputSink {
+
+    public:
+        OutputSink(const std::string &path, bool append, bool compress);
+        ~OutputSink();
+
+        void write(const std::string &data);
+        void close();
+
+        /** @brief Whether the output file was empty when it was opened */
+        bool wasEmpty() const { return this->was_empty; }
+
+        /** @brief The first write, compression or close error (empty if none), after which nothing is written */
+        const std::string &getError() const { return this->error; }
+
+    private:
+        void fail(const std::string &message);
+
+        std::string path;
+        std::string error;
+        bool was_empty = true;
+        FILE *file = nullptr;
+        void *compression_context = nullptr;
+        std::vector<char> compression_buffer;
+    };
+
+    /**
+     *  @brief A writer that hands records over to a background thread through a lock-free queue, so that
+     *         the thread producing them (e.g., the simulation) never blocks on serialization, compression
+     *         or I/O. Records are serialized with a user-provided function in the background thread.
+     */
+    template<typename T>
+    class AsyncWriter {
+
+    public:
+        /** @brief A function that appends the serialized form of a record to a string */
+        using Serializer = std::function<void(const T &, std::string &)>;
+
+        /**
+         * @brief Constructor, which opens the output file and starts the background thread
+         *
+         * @param path: the path of the output file
+         * @param serializer: the function that serializes records
+         * @param append: whether to append to the output file rather than truncating it
+         * @param compress: whether to zstd-compress the output
+         * @param header: a header written first if the output file is empty (e.g., CSV column names)
+         * @param capacity: the number of records the queue can hold before the producer has to wait (its slots
+         *        are allocated upfront, so small outputs should ask for a small queue)
+         *
+         * @throw std::runtime_error
+         */
+        AsyncWriter(const std::string &path, Serializer serializer, bool append = false, bool compress = false,
+                    const std::string &header = "", size_t capacity = 65536) : queue(capacity), sink(path, append, compress),
+                                                                              serializer(std::move(serializer)) {
+            if (this->sink.wasEmpty()) {
+                this->sink.write(header);
+            }
+            this->worker = std::thread([this]() { this->run(); });
+        }
+
+        /**
+         * @brief Destructor, which closes the writer if it was not closed, reporting (not throwing) write errors
+         */
+        ~AsyncWriter() {
+            try {
+                this->close();
+            } catch (std::runtime_error &e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+            }
+        }
+
+        /**
+         * @brief Hand a record over to the background thread (waits only if the queue is full)
+         *
+         * @param record: a record
+         */
+        void write(T record) {
+            while (not this->queue.tryPush(record)) {
+                std::this_thread::yield();
+            }
+        }
+
+        /**
+         * @brief Wait for all records to be written, and close the output file
+         *
+         * @throw std::runtime_error if a record could not be written
+         */
+        void close() {
+            if (this->worker.joinable()) {
+                this->closing.store(true, std::memory_order_release);
+                this->worker.join();
+                this->sink.close();
+                if (not this->sink.getError().empty()) {
+                    throw std::runtime_error(this->sink.getError());
+                }
+            }
+        }
+
+    private:
+        /** @brief Size above which serialized records are handed to the output sink */
+        static constexpr size_t flush_threshold = 1 << 20;
+
+        void run() {
+            std::string buffer;
+            T record;
+            while (true) {
+                bool closing = this->closing.load(std::memory_order_acquire);
+                bool popped = false;
+                while (this->queue.tryPop(record)) {
+                    this->serializer(record, buffer);
+                    popped = true;
+                    if (buffer.size() >= flush_threshold) {
+                        this->sink.write(buffer);
+                        buffer.clear();
+                    }
+                }
+                // All records pushed before "closing" was set have been popped at this point
+                if (closing) {
+                    break;
+                }
+                if (not popped) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+            this->sink.write(buffer);
+        }
+
+        SpscQueue<T> queue;
+        OutputSink sink;
+        Serializer serializer;
+        std::atomic<bool> closing{false};
+        std::thread worker;
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_ASYNCWRITER_H
@@ -0,0 +1,47 @@
+
+#ifndef WRENCH_EXAMPLE_CONTEXTCONFIGURATION_H
+#define WRENCH_EXAMPLE_CONTEXTCONFIGURATION_H
+
+#include <string>
+#include <vector>
+
+namespace wrench {
+
+    /**
+     *  @brief The selection of the SimGrid context backend ("contexts/factory": raw, ucontext, thread or
+     *         boost) and actor stack size ("contexts/stack-size", in KiB) of a run. Both must be set
+     *         before SimGrid is initialized, i.e., before the workflow is loaded, so the number of tasks
+     *         is counted with a cheap scan of the workflow file (or read from the recipe repository index).
+     *
+     *  Unless given explicitly, the backend is left to SimGrid (raw contexts where available, which are
+     *  the fastest and have no per-actor OS thread), and the stack size shrinks as the workflow grows,
+     *  so that the many actors WRENCH creates for large workflows fit in memory.
+     *
+     *  Actors run sequentially unless a number of worker threads is given ("contexts/nthreads"): SimGrid
+     *  then runs the actors that are ready in a scheduling round in parallel, if there are at least
+     *  "contexts/parallel-threshold" of them (smaller rounds are cheaper to run sequentially). With "auto",
+     *  large workflows, whose rounds have many ready actors, use several threads.
+     */
+    class ContextConfiguration {
+
+    public:
+        /** @brief The stack size SimGrid uses by default, in KiB */
+        static constexpr unsigned long default_stack_size = 8192;
+        /** @brief The minimum number of ready actors for a scheduling round to run in parallel */
+        static constexpr unsigned long default_parallel_threshold = 16;
+        /** @brief The maximum number of worker threads selected automatically */
+        static constexpr unsigned long max_auto_threads = 8;
+
+        static unsigned long countTasks(const std::string &workflow, const std::string &recipe_repository);
+        static unsigned long selectStackSize(unsigned long num_tasks);
+        static unsigned long selectNumThreads(unsigned long num_tasks, unsigned long hardware_threads);
+        static std::vector<std::string> getConfigArguments(unsigned long num_tasks,
+                                                           const std::string &factory,
+                                                           const std::string &stack_size,
+                                                           const std::string &threads,
+                                                           const std::string &parallel_threshold,
+                                                           const std::vector<std::string> &arguments);
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_CONTEXTCONFIGURATION_H
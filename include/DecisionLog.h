@@ -0,0 +1,62 @@
+
+#ifndef WRENCH_EXAMPLE_DECISIONLOG_H
+#define WRENCH_EXAMPLE_DECISIONLOG_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AsyncWriter.h"
+
+namespace wrench {
+
+    /**
+     *  @brief A scheduling decision of the WMS (a task placement, a pilot job request, a pstate change, or a
+     *         batch node power-down or power-up)
+     */
+    struct Decision {
+        double date = 0.0;
+        /** @brief The decision kind: "task", "pilot_job", "pstate", "power_down" or "power_up" */
+        std::string kind;
+        /** @brief What the decision is about (a task ID, a number of nodes, a host name) */
+        std::string subject;
+        /** @brief What was decided (a compute service name, a walltime, a pstate) */
+        std::string target;
+    };
+
+    /**
+     *  @brief A log of the decisions of the WMS, written as CSV (index,date,kind,subject,target) through an
+     *         AsyncWriter, and optionally compared online with the log of a baseline run. Since simulations
+     *         are deterministic, two runs with the same inputs proceed identically until their first
+     *         divergent decision, which the log reports (see --baseline-decisions).
+     */
+    class DecisionLog {
+
+    public:
+        DecisionLog(const std::string &path, const std::string &baseline_path);
+
+        bool record(const Decision &decision);
+        void close();
+
+        /** @brief Get the number of decisions recorded so far */
+        unsigned long getNumDecisions() const { return this->num_decisions; }
+        /** @brief Whether a baseline log is compared with */
+        bool hasBaseline() const { return this->has_baseline; }
+        long getFirstDivergence() const;
+        double getFirstDivergenceDate() const;
+
+    private:
+        static std::vector<Decision> readDecisions(const std::string &path);
+
+        std::unique_ptr<AsyncWriter<Decision>> writer;
+        bool has_baseline = false;
+        std::vector<Decision> baseline;
+        unsigned long num_decisions = 0;
+        /** @brief The index of the first decision that differs from the baseline (-1 if none so far) */
+        long first_divergence = -1;
+        double first_divergence_date = -1.0;
+        double last_date = 0.0;
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_DECISIONLOG_H
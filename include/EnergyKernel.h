@@ -0,0 +1,88 @@
+
+#ifndef WRENCH_EXAMPLE_ENERGYKERNEL_H
+#define WRENCH_EXAMPLE_ENERGYKERNEL_H
+
+#include <string>
+#include <vector>
+
+#include "PowerModel.h"
+
+namespace wrench {
+
+    /**
+     *  @brief A period during which some cores of a host are busy computing
+     */
+    struct UtilizationInterval {
+        /** @brief The index of the host in the host list */
+        unsigned long host;
+        double start_date;
+        double end_date;
+        unsigned long num_cores;
+    };
+
+    /**
+     *  @brief A change of the power state of a host
+     */
+    struct PstateChange {
+        /** @brief The index of the host in the host list */
+        unsigned long host;
+        double date;
+        unsigned long pstate;
+    };
+
+    /**
+     *  @brief Energy and power figures of all hosts over one time window
+     */
+    struct EnergyWindowReport {
+        double window_start;
+        double window_end;
+        /** @brief Per-host energy, in Joules */
+        std::vector<double> energy;
+        /** @brief Per-host average power, in Watts */
+        std::vector<double> average_power;
+        /** @brief Per-host peak power, in Watts */
+        std::vector<double> peak_power;
+        /** @brief The power bin edges of the histogram, in Watts */
+        std::vector<double> histogram_edges;
+        /** @brief Per-host time spent in each power bin, in seconds (host-major, one row of edges-1 bins per host) */
+        std::vector<double> histogram;
+    };
+
+    /**
+     *  @brief The power timelines of all hosts of a simulation, stored as a structure of arrays: the
+     *         piecewise-constant power of host h is described by segments [offsets[h], offsets[h+1])
+     *         of the start_dates/end_dates/powers arrays, so that energy and power figures for any
+     *         time window are computed in a single pass over contiguous memory
+     */
+    class PowerTimelines {
+
+    public:
+        PowerTimelines(std::vector<std::string> hostnames,
+                       const std::vector<std::vector<HostPowerProfile>> &pstate_profiles,
+                       std::vector<UtilizationInterval> intervals,
+                       std::vector<PstateChange> pstate_changes,
+                       double horizon,
+                       bool consolidated_sockets = false);
+
+        EnergyWindowReport integrate(double window_start, double window_end,
+                                     const std::vector<double> &histogram_edges = {}) const;
+
+        /** @brief Get the names of the hosts, in timeline order */
+        const std::vector<std::string> &getHostnames() const { return this->hostnames; }
+        /** @brief Get the total number of segments of all timelines */
+        size_t getNumSegments() const { return this->powers.size(); }
+        /** @brief Get the date at which all timelines end */
+        double getHorizon() const { return this->horizon; }
+
+        std::vector<std::string> hostnames;
+        std::vector<size_t> offsets;
+        std::vector<double> start_dates;
+        std::vector<double> end_dates;
+        std::vector<double> powers;
+
+    private:
+        double horizon;
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_ENERGYKERNEL_H
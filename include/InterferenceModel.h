@@ -0,0 +1,45 @@
+
+#ifndef WRENCH_EXAMPLE_INTERFERENCEMODEL_H
+#define WRENCH_EXAMPLE_INTERFERENCEMODEL_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "TaskGraphStore.h"
+
+namespace wrench {
+
+    /**
+     *  @brief A model of the slowdown of tasks that share a node, due to memory bandwidth and cache
+     *         contention. Each task category has a memory intensity in [0, 1] (by default, its bytes
+     *         read and written per flop relative to a fixed reference, the memory bandwidth per flop of
+     *         the nodes, capped at 1), and a task runs slower by a factor
+     *         1 + (max_slowdown - 1) * intensity * pressure, where the pressure is the intensity of the
+     *         tasks running alongside it per other core of the node, in [0, 1]. A memory-bound task on a
+     *         node full of memory-bound tasks thus runs max_slowdown times slower. The slowdown is fixed
+     *         when the task starts, from the tasks running then: tasks that start or end later on the
+     *         node do not change it.
+     */
+    class InterferenceModel {
+
+    public:
+        /** @brief The reference bytes per flop when the nodes have no memory_bandwidth property: 100 GB/s for 1 Tflop/s */
+        static constexpr double DEFAULT_REFERENCE_BYTES_PER_FLOP = 0.1;
+
+        InterferenceModel(const TaskGraphStore &task_graph_store, double max_slowdown, double reference_bytes_per_flop,
+                          const std::map<std::string, double> &category_intensities);
+
+        /** @brief Get the memory intensity of a task category, in [0, 1] */
+        double getIntensity(unsigned int category) const { return this->intensities[category]; }
+
+        double getSlowdown(unsigned int category, double co_runner_intensity, unsigned long num_cores) const;
+
+    private:
+        double max_slowdown;
+        /** @brief The memory intensity of each task category */
+        std::vector<double> intensities;
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_INTERFERENCEMODEL_H
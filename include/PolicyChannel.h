@@ -0,0 +1,78 @@
+
+#ifndef WRENCH_EXAMPLE_POLICYCHANNEL_H
+#define WRENCH_EXAMPLE_POLICYCHANNEL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace wrench {
+
+    /**
+     *  @brief What an external scheduling policy observes at a scheduling decision, as flat arrays
+     */
+    struct PolicyObservation {
+        double date = 0.0;
+        /** @brief The energy consumed by all hosts so far, in Joules */
+        double energy = 0.0;
+
+        /** @brief The predicted runtime of each ready task at the CPU core speed, in seconds */
+        std::vector<double> task_predicted_runtimes;
+        std::vector<double> task_flops;
+        /** @brief The bytes each ready task reads and writes */
+        std::vector<double> task_io_bytes;
+        std::vector<double> task_categories;
+        std::vector<double> task_num_children;
+        /** @brief The index of each ready task in the workflow */
+        std::vector<uint32_t> task_indices;
+
+        /** @brief The idle cores of each compute service slot (0 for a slot whose service is not available) */
+        std::vector<double> service_idle_cores;
+        std::vector<double> service_total_cores;
+        /** @brief The per-core speed of each compute service slot, in flop/sec */
+        std::vector<double> service_speeds;
+        std::vector<double> service_idle_watts;
+        std::vector<double> service_all_cores_watts;
+        /** @brief Whether each compute service slot is an accelerator service */
+        std::vector<double> service_accelerators;
+
+        /** @brief The current pstate of each host of the platform */
+        std::vector<double> host_pstates;
+        /** @brief Whether each host of the platform is powered down */
+        std::vector<double> host_powered_down;
+    };
+
+    /**
+     *  @brief The channel through which an external process (e.g., src/wrench_env.py) makes the scheduling
+     *         decisions of the WMS: at each decision, the WMS sends an observation and blocks until it
+     *         receives an action, i.e., a compute service slot (or -1 to defer) for each ready task.
+     *
+     *  Messages are little-endian. Observation: u32 type (0 for an observation, 1 for the end of the
+     *  episode), u32 number of ready tasks T, u32 number of service slots S, u32 number of hosts H, f64 date,
+     *  f64 energy, then the f64 arrays of PolicyObservation in declaration order (T task values, S service
+     *  values, H host values each), then the u32 task indices. Action: u32 T, then T i32 slots.
+     */
+    class PolicyChannel {
+
+    public:
+        PolicyChannel(int read_fd, int write_fd);
+        ~PolicyChannel();
+        PolicyChannel(const PolicyChannel &) = delete;
+        PolicyChannel &operator=(const PolicyChannel &) = delete;
+
+        static std::pair<int, int> parseFileDescriptors(const std::string &fds);
+
+        std::vector<int32_t> decide(const PolicyObservation &observation);
+        void endEpisode(const PolicyObservation &observation);
+
+    private:
+        void send(uint32_t type, const PolicyObservation &observation);
+
+        int read_fd;
+        int write_fd;
+        /** @brief The message buffer, reused across decisions */
+        std::string buffer;
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_POLICYCHANNEL_H
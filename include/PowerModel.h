@@ -0,0 +1,58 @@
+
+#ifndef WRENCH_EXAMPLE_POWERMODEL_H
+#define WRENCH_EXAMPLE_POWERMODEL_H
+
+#include <string>
+#include <vector>
+
+namespace wrench {
+
+    /**
+     *  @brief The power profile of a host in one of its pstates, as described by its SimGrid
+     *         "wattage_per_state" property (idle:one-core:all-cores for each pstate, comma-separated)
+     *         and by the speed of that pstate, used by the WMS to estimate the energy cost of a
+     *         placement or of a frequency change before making it.
+     *
+     *         On hosts with several sockets or with power-gated sockets, each socket draws its share of the
+     *         idle power (or the gated power, if it has no busy core), plus the one-core power step when
+     *         its first core becomes busy, plus its share of the dynamic power of its busy cores; the busy
+     *         cores are either spread evenly over the sockets (the OS default) or consolidated onto as few
+     *         sockets as possible. With all cores busy, or a single one, this matches the host-level model.
+     */
+    struct HostPowerProfile {
+        /** @brief The pstate the profile is for */
+        unsigned long pstate = 0;
+        /** @brief The number of cores of the host */
+        unsigned long num_cores = 1;
+        /** @brief The per-core speed of the host, in flop/sec */
+        double speed = 1.0;
+        /** @brief Power when no core is busy, in Watts */
+        double idle_watts = 0.0;
+        /** @brief Power when a single core is busy, in Watts */
+        double one_core_watts = 0.0;
+        /** @brief Power when all cores are busy, in Watts */
+        double all_cores_watts = 0.0;
+        /** @brief The number of CPU sockets of the host, which share its cores evenly ("sockets" property) */
+        unsigned long num_sockets = 1;
+        /** @brief Power of a power-gated socket, i.e., with no busy core, in Watts ("socket_gated_wattage"
+         *         property; negative if idle sockets are not gated) */
+        double gated_socket_watts = -1.0;
+
+        double getPower(double busy_cores, bool consolidated = false) const;
+        double getMarginalPower(double busy_cores, double additional_cores = 1.0, bool consolidated = false) const;
+        /** @brief Whether the power of the host depends on how its busy cores are spread over its sockets */
+        bool isSocketAware() const { return this->num_sockets > 1 or this->gated_socket_watts >= 0.0; }
+        double getEnergyPerFlop(double busy_cores, bool consolidated = false) const;
+
+        static HostPowerProfile fromHost(const std::string &hostname);
+        static HostPowerProfile fromHost(const std::string &hostname, unsigned long pstate);
+        static std::vector<HostPowerProfile> getPstateProfiles(const std::string &hostname);
+        static long getSleepPstate(const std::string &hostname);
+        static double getBootTime(const std::string &hostname);
+        static long getTurboPstate(const std::string &hostname);
+        static unsigned long getTurboMaxCores(const std::string &hostname);
+        static double getWakeUpLatency(const std::string &hostname);
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_POWERMODEL_H
@@ -0,0 +1,57 @@
+
+#ifndef WRENCH_EXAMPLE_RECIPEREPOSITORY_H
+#define WRENCH_EXAMPLE_RECIPEREPOSITORY_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <wrench-dev.h>
+
+namespace wrench {
+
+    /**
+     *  @brief A read-only, memory-mapped repository of packed workflow recipes (as written by
+     *         src/wfpackrecipes.py): recipes are looked up by key <family>/<number of tasks>/<seed>
+     *         and a Workflow is built directly from the mapped arrays, without parsing, while the
+     *         OS page cache shares the file among all the simulations of a sweep
+     */
+    class RecipeRepository {
+
+    public:
+        /** @brief An entry of the repository index */
+        struct Entry {
+            /** @brief The workflow family (e.g., "blast") */
+            std::string family;
+            /** @brief The number of tasks */
+            unsigned long num_tasks;
+            /** @brief The seed (index of the recipe among those of the same family and size) */
+            unsigned long seed;
+            /** @brief The offset of the recipe block in the repository file */
+            size_t offset;
+            /** @brief The length of the recipe block */
+            size_t length;
+        };
+
+        explicit RecipeRepository(const std::string &path);
+        ~RecipeRepository();
+        RecipeRepository(const RecipeRepository &) = delete;
+        RecipeRepository &operator=(const RecipeRepository &) = delete;
+
+        /** @brief Get the index entries, in packing order */
+        const std::vector<Entry> &getEntries() const { return this->entries; }
+
+        static std::string getKey(const Entry &entry);
+        bool hasRecipe(const std::string &key) const;
+        std::shared_ptr<Workflow> createWorkflow(const std::string &key, const std::string &reference_flop_rate) const;
+
+    private:
+        std::string path;
+        const char *data = nullptr;
+        size_t size = 0;
+        std::vector<Entry> entries;
+        std::unordered_map<std::string, size_t> entry_indices;
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_RECIPEREPOSITORY_H
@@ -0,0 +1,84 @@
+
+#ifndef WRENCH_EXAMPLE_RESULTSDATABASE_H
+#define WRENCH_EXAMPLE_RESULTSDATABASE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace wrench {
+
+    /**
+     *  @brief The summary of a simulation run, i.e., a row of the runs table
+     */
+    struct ResultsRun {
+        /** @brief The run ID of the CSV result files ("extk-<number of tasks>") */
+        std::string run_id;
+        std::string platform;
+        /** @brief The workflow file (or packed recipe key) */
+        std::string workflow;
+        unsigned long num_tasks = 0;
+        unsigned long tasks_failed = 0;
+        double makespan = 0.0;
+        /** @brief The energy consumed by all the hosts, in Joules */
+        double energy = 0.0;
+    };
+
+    /**
+     *  @brief The results of a run for a host, i.e., a row of the hosts table
+     */
+    struct ResultsHost {
+        std::string host_name;
+        unsigned long num_cores = 0;
+        double energy = 0.0;
+        /** @brief The average power over the run, in Watts */
+        double power = 0.0;
+    };
+
+    /**
+     *  @brief The execution of a task, i.e., a row of the tasks table
+     */
+    struct ResultsTask {
+        std::string task_id;
+        std::string host_name;
+        unsigned long num_cores = 0;
+        double start_date = 0.0;
+        double end_date = 0.0;
+        double compute_time = 0.0;
+        double io_input_time = 0.0;
+        double io_output_time = 0.0;
+        /** @brief The number of failed executions of the task before the one that completed */
+        unsigned long failures = 0;
+    };
+
+    /**
+     *  @brief An embedded SQLite database of simulation results, with indexed tables of runs, parameters
+     *         (the simulator options of each run), hosts, tasks and metrics, which src/results_db.py also
+     *         fills from CSV result files and queries. Each run is inserted in one transaction, with
+     *         prepared statements; concurrent simulations may share a database on a local filesystem
+     *         (write-ahead logging, and a wait of up to a minute while another run is being inserted).
+     *
+     *  SQLite is optional: without it, opening a database throws.
+     */
+    class ResultsDatabase {
+
+    public:
+        explicit ResultsDatabase(const std::string &path);
+        ~ResultsDatabase();
+
+        static bool isAvailable();
+
+        long insertRun(const ResultsRun &run,
+                       const std::map<std::string, std::string> &parameters,
+                       const std::vector<ResultsHost> &hosts,
+                       const std::vector<ResultsTask> &tasks,
+                       const std::map<std::string, double> &metrics);
+
+    private:
+        /** @brief The SQLite connection (nullptr when built without SQLite) */
+        void *connection = nullptr;
+        std::string path;
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_RESULTSDATABASE_H
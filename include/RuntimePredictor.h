@@ -0,0 +1,58 @@
+
+#ifndef WRENCH_EXAMPLE_RUNTIMEPREDICTOR_H
+#define WRENCH_EXAMPLE_RUNTIMEPREDICTOR_H
+
+#include <vector>
+
+namespace wrench {
+
+    /**
+     *  @brief An online predictor of task compute and I/O times, learned per task category
+     *         from the tasks that complete during the simulation (exponentially weighted moving
+     *         averages of the observed/static compute time ratio and of the I/O time per byte).
+     *         Categories are the dense category indices of the TaskGraphStore.
+     */
+    class RuntimePredictor {
+
+    public:
+        explicit RuntimePredictor(double alpha = 0.3);
+
+        double predictComputeTime(unsigned int category, double flops, double speed) const;
+        double predictIOTime(unsigned int category, double bytes) const;
+
+        void observe(unsigned int category, double flops, double speed, double bytes,
+                     double compute_time, double io_time,
+                     double predicted_compute_time, double predicted_io_time);
+
+        /** @brief Get the number of completed tasks the predictor has learned from */
+        unsigned long getNumObservations() const { return this->num_observations; }
+        double getComputeTimeError() const;
+        double getStaticComputeTimeError() const;
+        double getIOTimeError() const;
+
+    private:
+        /** @brief What is learned about one task category */
+        struct CategoryModel {
+            /** @brief Observed compute time over the static flops/speed estimate */
+            double compute_ratio = 1.0;
+            /** @brief Observed I/O time per byte read or written, in seconds */
+            double io_time_per_byte = 0.0;
+            /** @brief Number of observations (0 if the category was never observed) */
+            unsigned long count = 0;
+        };
+
+        double alpha;
+        std::vector<CategoryModel> models;
+        /** @brief The model of all categories together, used for categories never observed */
+        CategoryModel global_model;
+
+        unsigned long num_observations = 0;
+        double compute_time_absolute_error = 0.0;
+        double static_compute_time_absolute_error = 0.0;
+        double io_time_absolute_error = 0.0;
+        double total_compute_time = 0.0;
+        double total_io_time = 0.0;
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_RUNTIMEPREDICTOR_H
@@ -0,0 +1,49 @@
+
+#ifndef WRENCH_EXAMPLE_SCHEDULEPLAN_H
+#define WRENCH_EXAMPLE_SCHEDULEPLAN_H
+
+#include <string>
+#include <vector>
+
+#include "TaskGraphStore.h"
+
+namespace wrench {
+
+    /**
+     *  @brief A static schedule computed offline for the whole workflow (e.g., by src/plan_schedule.py):
+     *         the compute service slot, core count, pstate and start order of every task, along with the
+     *         start and end dates the planner expects, which SimpleWMS compares with the execution.
+     *
+     *  File format (CSV with a header line): task_id,service,num_cores,pstate,order,planned_start,planned_end,
+     *  where service is one of the slot names (vm1, vm2, vm3, pilot, accelerator). Tasks run in increasing
+     *  order on each slot, which must be consistent with the task dependencies.
+     */
+    class SchedulePlan {
+
+    public:
+        /** @brief The entry of a task in the plan */
+        struct PlannedTask {
+            /** @brief The compute service slot, as an index in getSlotNames() */
+            unsigned long slot = 0;
+            unsigned long num_cores = 1;
+            unsigned long pstate = 0;
+            unsigned long order = 0;
+            double planned_start = 0.0;
+            double planned_end = 0.0;
+        };
+
+        SchedulePlan(const std::string &path, const TaskGraphStore &task_graph_store);
+
+        static const std::vector<std::string> &getSlotNames();
+
+        /** @brief Get the plan entry of each task, by task index */
+        const std::vector<PlannedTask> &getPlannedTasks() const { return this->planned_tasks; }
+
+    private:
+        void checkDependencies(const std::string &path, const TaskGraphStore &task_graph_store) const;
+
+        std::vector<PlannedTask> planned_tasks;
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_SCHEDULEPLAN_H
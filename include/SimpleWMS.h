@@ -4,8 +4,46 @@
 
 #include <wrench-dev.h>
 
+#include "AsyncWriter.h"
+#include "DecisionLog.h"
+#include "InterferenceModel.h"
+#include "PolicyChannel.h"
+#include "PowerModel.h"
+#include "RuntimePredictor.h"
+#include "SchedulePlan.h"
+#include "SimulationProfiler.h"
+#include "TaskGraphStore.h"
+#include "TimelineRecorder.h"
+
 namespace wrench {
 
+    /**
+     *  @brief A task completion or failure, as written to the execution trace
+     */
+    struct TaskTraceRecord {
+        double date = 0.0;
+        unsigned long task_index = 0;
+        bool failed = false;
+        std::string execution_host;
+        unsigned long num_cores = 0;
+        double start_date = 0.0;
+        double end_date = 0.0;
+    };
+
+    /**
+     *  @brief The execution of a task compared with the schedule plan
+     */
+    struct PlanDeviation {
+        unsigned long task_index = 0;
+        double planned_start = 0.0;
+        double actual_start = 0.0;
+        double planned_end = 0.0;
+        double actual_end = 0.0;
+        unsigned long planned_pstate = 0;
+        /** @brief The pstate of the host the task ran on, at completion */
+        unsigned long actual_pstate = 0;
+    };
+
     /**
      *  @brief A simple WMS implementation
      */
@@ -13,16 +51,53 @@ namespace wrench {
 
     public:
         SimpleWMS(const std::shared_ptr<Workflow> &workflow,
+                  const std::shared_ptr<TaskGraphStore> &task_graph_store,
                   const std::shared_ptr<BatchComputeService> &batch_compute_service,
                   const std::shared_ptr<CloudComputeService> &cloud_compute_service,
                   const std::shared_ptr<StorageService> &storage_service,
                   const std::string &hostname);
 
+        void setAcceleratorComputeService(const std::shared_ptr<BareMetalComputeService> &accelerator_compute_service,
+                                          const std::map<std::string, double> &accelerator_speedups);
+
+        void setRuntimePredictor(const RuntimePredictor &runtime_predictor);
+
+        void setTraceWriter(const std::shared_ptr<AsyncWriter<TaskTraceRecord>> &trace_writer);
+
+        void setTimelineRecorder(const std::shared_ptr<TimelineRecorder> &timeline_recorder);
+
+        void setDvfsPolicy(const std::string &dvfs_policy);
+
+        void setSocketPlacement(const std::string &socket_placement);
+
+        void setPlacementPolicy(const std::string &placement_policy);
+
+        void setPowerDownDelay(double power_down_delay);
+
+        void setDecisionLog(const std::shared_ptr<DecisionLog> &decision_log, bool stop_at_divergence);
+
+        void setProfiler(const std::shared_ptr<SimulationProfiler> &profiler);
+
+        void setPolicyChannel(const std::shared_ptr<PolicyChannel> &policy_channel);
+
+        void setSchedulePlan(const std::shared_ptr<SchedulePlan> &schedule_plan);
+
+        void setInterferenceModel(const std::shared_ptr<InterferenceModel> &interference_model, bool avoid_interference);
+
+        /** @brief Get the schedule plan the WMS executes, if any */
+        const std::shared_ptr<SchedulePlan> &getSchedulePlan() const { return this->schedule_plan; }
+        /** @brief Get the executions of the tasks compared with the schedule plan, once the simulation is over */
+        const std::vector<PlanDeviation> &getPlanDeviations() const { return this->plan_deviations; }
+
+        /** @brief Get the metrics the WMS reports about its own decisions, once the simulation is over */
+        const std::map<std::string, double> &getMetrics() const { return this->metrics; }
+
     protected:
         void processEventStandardJobCompletion(std::shared_ptr<StandardJobCompletedEvent> event) override;
         void processEventStandardJobFailure(std::shared_ptr<StandardJobFailedEvent> event) override;
         void processEventPilotJobStart(std::shared_ptr<PilotJobStartedEvent> event) override;
         void processEventPilotJobExpiration(std::shared_ptr<PilotJobExpiredEvent> event) override;
+        void processEventTimer(std::shared_ptr<TimerEvent> event) override;
 
     private:
         int main() override;
@@ -34,17 +109,177 @@ namespace wrench {
         std::shared_ptr<PilotJob> pilot_job = nullptr;
         /** @brief A boolean to indicate whether the pilot job is running */
         bool pilot_job_is_running = false;
+        /** @brief The date at which the pilot job started */
+        double pilot_job_start_date = 0.0;
+        /** @brief The walltime requested for the pilot job, in seconds */
+        double pilot_job_walltime = 3600000;
+        /** @brief The number of nodes requested for the pilot job */
+        unsigned long pilot_job_num_nodes = 6;
+        /** @brief The number of pilot jobs submitted so far (which identifies the boot timers) */
+        unsigned long num_pilot_jobs = 0;
+
+        /** @brief The batch compute nodes that are powered down */
+        std::set<std::string> powered_down_hosts;
+        /** @brief The number of cores of each batch compute node */
+        std::map<std::string, unsigned long> batch_hosts;
+        /** @brief The idle power of the hosts that are never powered down, in Watts */
+        double always_on_idle_power = 0.0;
+        /** @brief The pilot job nodes that are booting after the WMS woke them up for consolidated placement */
+        std::set<std::string> booting_hosts;
+        /** @brief The cores of each pilot job node that run tasks pinned to it by consolidated placement */
+        std::map<std::string, unsigned long> pilot_host_busy_cores;
+        /** @brief The date since which each awake pilot job node runs no task, with consolidated placement */
+        std::map<std::string, double> pilot_host_idle_since;
 
         void scheduleReadyTasks(std::vector<std::shared_ptr<WorkflowTask>> ready_tasks,
                                 std::shared_ptr<JobManager> job_manager,
                                 std::set<std::shared_ptr<BareMetalComputeService>> compute_services);
 
+        bool scheduleTasksWithPolicy(const std::vector<std::shared_ptr<WorkflowTask>> &ready_tasks,
+                                     const std::shared_ptr<JobManager> &job_manager,
+                                     const std::set<std::shared_ptr<BareMetalComputeService>> &compute_services);
+        PolicyObservation observePolicyState(const std::vector<std::shared_ptr<WorkflowTask>> &ready_tasks,
+                                             const std::vector<std::shared_ptr<BareMetalComputeService>> &slots);
+        std::vector<std::shared_ptr<BareMetalComputeService>> getServiceSlots(
+                const std::set<std::shared_ptr<BareMetalComputeService>> &compute_services) const;
+        bool submitTask(const std::shared_ptr<WorkflowTask> &task,
+                        const std::shared_ptr<BareMetalComputeService> &target_cs,
+                        const std::shared_ptr<JobManager> &job_manager,
+                        unsigned long num_cores = 1,
+                        const std::string &hostname = "");
+        void scheduleTasksWithPlan(const std::shared_ptr<JobManager> &job_manager,
+                                   const std::set<std::shared_ptr<BareMetalComputeService>> &compute_services);
+        void recordPlanDeviation(unsigned long task_index, double start_date, double end_date, unsigned long pstate);
+
+        double estimateTaskEnergy(unsigned long task_index,
+                                  const std::shared_ptr<BareMetalComputeService> &cs,
+                                  double speed,
+                                  const std::string &hostname = "");
+        std::string selectPilotHost(const std::shared_ptr<BareMetalComputeService> &cs, unsigned long num_cores,
+                                    unsigned long num_cores_waiting_for_boot) const;
+        void wakeUpPilotHost(const std::string &hostname);
+        void powerDownIdlePilotHosts();
+
+        double getPowerDownDelay(const std::string &hostname) const;
+        double predictTaskRuntime(unsigned long task_index, double speed) const;
+        double getAcceleratorSpeed(unsigned long task_index);
+        bool canStartTask(unsigned long task_index, const std::shared_ptr<BareMetalComputeService> &cs);
+        bool exceedsPilotJobWalltime(unsigned long task_index, const std::shared_ptr<BareMetalComputeService> &cs);
+        double predictSlowdown(unsigned long task_index, const std::shared_ptr<BareMetalComputeService> &cs);
+        double predictWakeUpLatency(const std::shared_ptr<BareMetalComputeService> &cs);
+        std::map<std::shared_ptr<DataFile>, std::shared_ptr<FileLocation>> getFileLocations(unsigned long task_index) const;
+        double predictPilotJobWalltime(unsigned long num_nodes) const;
+        unsigned long selectPilotJobNodeCount() const;
+        void powerDownBatchHosts(const std::vector<std::string> &hostnames);
+        double powerUpBatchHosts(const std::vector<std::string> &hostnames);
+        void applyDvfsPolicy(const std::set<std::shared_ptr<BareMetalComputeService>> &compute_services, bool saturated);
+        unsigned long selectPstate(const std::string &hostname, unsigned long busy_cores, bool saturated);
+        std::vector<std::pair<double, unsigned long>> getRemainingWork(const std::string &hostname) const;
+        static double predictEnergyToCompletion(const HostPowerProfile &profile, bool consolidated,
+                                                const std::vector<std::pair<double, unsigned long>> &remaining_work,
+                                                double horizon, double idle_power);
+        void updateTaskProgress(const std::string &hostname);
+        void removeRunningTask(unsigned long task_index);
+        void recordDecision(const std::string &kind, const std::string &subject, const std::string &target);
+
         std::shared_ptr<Workflow> workflow;
+        std::shared_ptr<TaskGraphStore> task_graph_store;
         std::shared_ptr<BatchComputeService> batch_compute_service;
         std::shared_ptr<CloudComputeService> cloud_compute_service;
         std::shared_ptr<StorageService> storage_service;
 
         std::map<std::shared_ptr<ComputeService>, unsigned long> core_utilization_map;
+        /** @brief The total number of cores of each compute service */
+        std::map<std::shared_ptr<ComputeService>, unsigned long> total_cores_map;
+        /** @brief The power profile of (the hosts of) each compute service */
+        std::map<std::shared_ptr<ComputeService>, HostPowerProfile> power_profile_map;
+
+        /** @brief The physical hosts of each compute service, with their number of cores */
+        std::map<std::shared_ptr<ComputeService>, std::map<std::string, unsigned long>> physical_hosts_map;
+        /** @brief The power profiles of each physical host, by pstate */
+        std::map<std::string, std::vector<HostPowerProfile>> host_pstate_profiles;
+        /** @brief The DVFS policy: "performance" (fastest pstate), "powersave" (slowest pstate) or "energy" */
+        std::string dvfs_policy = "performance";
+        /** @brief Whether the tasks of a node are consolidated onto as few CPU sockets as possible (rather than spread) */
+        bool consolidate_sockets = false;
+        /** @brief Whether ready tasks go where they add the least power, filling busy nodes before idle ones (rather than first fit) */
+        bool consolidate_placement = false;
+        /** @brief How long an idle pilot job node stays up before it is powered down, in seconds (negative: its
+         *         break-even time, after which the power-down saves more energy than the boot costs) */
+        double power_down_delay = -1.0;
+        /** @brief Whether CPU hosts have a turbo pstate, which the WMS then selects while few of their cores are busy */
+        bool turbo_available = false;
+
+        /** @brief An optional compute service on accelerator-equipped nodes */
+        std::shared_ptr<BareMetalComputeService> accelerator_compute_service = nullptr;
+        /** @brief The speedup over a CPU core of each task category (0 if not eligible for acceleration) */
+        std::vector<double> accelerator_speedups;
+        /** @brief The per-core speed of the CPU nodes, which accelerator speedups are relative to */
+        double cpu_reference_speed = 1.0;
+
+        /** @brief What was predicted for a task when it was submitted */
+        struct TaskPrediction {
+            /** @brief The speed the prediction is for, i.e., the core speed times the cores of the task (0 if the task is not running) */
+            double speed = 0.0;
+            double compute_time = 0.0;
+            double io_time = 0.0;
+            /** @brief The co-location slowdown applied to the task */
+            double slowdown = 1.0;
+            /** @brief The parallel efficiency the task was submitted with (accelerator speed, slowdown and wake-up latency) */
+            double efficiency = 1.0;
+            /** @brief The time the task waited for its socket to wake up, in seconds */
+            double wake_up_latency = 0.0;
+            /** @brief The pilot job node the task is pinned to (empty if none), and its number of cores */
+            std::string hostname;
+            unsigned long num_cores = 1;
+            /** @brief The physical host the task runs on, if the WMS knows it (empty otherwise) */
+            std::string physical_host;
+            /** @brief The predicted computation left at progress_date, in seconds at a core speed of 1 flop/sec */
+            double remaining_work = 0.0;
+            double progress_date = 0.0;
+        };
+        /** @brief The online predictor of task runtimes */
+        RuntimePredictor runtime_predictor;
+        /** @brief The predictions for the tasks currently running, by task index */
+        std::vector<TaskPrediction> task_predictions;
+        /** @brief The running tasks of each physical host the WMS knows (single-host services and pinned tasks), by task index */
+        std::map<std::string, std::set<unsigned long>> host_running_tasks;
+
+        /** @brief The co-location interference model, if any */
+        std::shared_ptr<InterferenceModel> interference_model = nullptr;
+        /** @brief Whether ready tasks go to the compute service where they are slowed down the least */
+        bool avoid_interference = false;
+        /** @brief The sum of the memory intensities of the tasks running on each compute service */
+        std::map<std::shared_ptr<ComputeService>, double> memory_pressure_map;
+
+        /** @brief The location of each file on the storage service, by file index */
+        std::vector<std::shared_ptr<FileLocation>> file_locations;
+
+        /** @brief The background writer of the execution trace, if any */
+        std::shared_ptr<AsyncWriter<TaskTraceRecord>> trace_writer = nullptr;
+        /** @brief The recorder of the Gantt chart and host utilization timeline, if any */
+        std::shared_ptr<TimelineRecorder> timeline_recorder = nullptr;
+        /** @brief The log of the WMS decisions, if any */
+        std::shared_ptr<DecisionLog> decision_log = nullptr;
+        /** @brief Whether to abort the workflow execution at the first decision that differs from the baseline */
+        bool stop_at_divergence = false;
+        /** @brief The simulation rate counters, if any */
+        std::shared_ptr<SimulationProfiler> profiler = nullptr;
+
+        /** @brief The channel to an external scheduling policy, if any (which then places all the tasks) */
+        std::shared_ptr<PolicyChannel> policy_channel = nullptr;
+        /** @brief The static schedule plan, if any (which then places all the tasks) */
+        std::shared_ptr<SchedulePlan> schedule_plan = nullptr;
+        /** @brief The tasks of each slot that have not been submitted yet, as (plan order, task index) */
+        std::vector<std::set<std::pair<unsigned long, unsigned long>>> plan_slot_queues;
+        /** @brief The executions of the completed tasks compared with the plan */
+        std::vector<PlanDeviation> plan_deviations;
+
+        /** @brief The compute services of the VMs, i.e., the first service slots of the external policy and of the plan */
+        std::vector<std::shared_ptr<BareMetalComputeService>> vm_compute_services;
+
+        /** @brief Metrics about the WMS decisions, reported along with the simulation results */
+        std::map<std::string, double> metrics;
     };
 }// namespace wrench
 #endif//WRENCH_EXAMPLE_SIMPLEWMS_H
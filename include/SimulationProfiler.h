@@ -0,0 +1,113 @@
+
+#ifndef WRENCH_EXAMPLE_SIMULATIONPROFILER_H
+#define WRENCH_EXAMPLE_SIMULATIONPROFILER_H
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+
+namespace wrench {
+
+    /**
+     *  @brief Counters of the simulation rate of a run: SimGrid actors, communications (WRENCH commport
+     *         messages and data transfers), computations, pending activities and clock advances, counted
+     *         through SimGrid signals, and the wall-clock time spent in the WMS (its decision code and its
+     *         event callbacks) vs in the rest of the simulation (SimGrid kernel and WRENCH services)
+     *
+     *  SimGrid does not expose its context switches: every completed activity resumes the actor that
+     *  waits for it, so the number of completed activities is reported as their (lower-bound) proxy.
+     */
+    class SimulationProfiler {
+
+    public:
+        /**
+         *  @brief A scope whose wall-clock time is accounted to the WMS
+         */
+        class WmsScope {
+        public:
+            explicit WmsScope(SimulationProfiler *profiler) : profiler(profiler) {
+                if (this->profiler) {
+                    this->profiler->enterWms();
+                }
+            }
+            ~WmsScope() {
+                if (this->profiler) {
+                    this->profiler->leaveWms();
+                }
+            }
+            WmsScope(const WmsScope &) = delete;
+            WmsScope &operator=(const WmsScope &) = delete;
+
+        private:
+            SimulationProfiler *profiler;
+        };
+
+        /**
+         *  @brief A scope, within a WmsScope, whose wall-clock time is not accounted to the WMS (e.g., a
+         *         blocking WRENCH call during which other actors run)
+         */
+        class SimulationScope {
+        public:
+            explicit SimulationScope(SimulationProfiler *profiler) : profiler(profiler) {
+                if (this->profiler) {
+                    this->depth = this->profiler->suspendWms();
+                }
+            }
+            ~SimulationScope() {
+                if (this->profiler) {
+                    this->profiler->resumeWms(this->depth);
+                }
+            }
+            SimulationScope(const SimulationScope &) = delete;
+            SimulationScope &operator=(const SimulationScope &) = delete;
+
+        private:
+            SimulationProfiler *profiler;
+            unsigned long depth = 0;
+        };
+
+        void install();
+        void start();
+        void stop();
+
+        /** @brief Count an event processed by the WMS */
+        void countWmsEvent() { this->wms_events++; }
+        /** @brief Record the number of ready tasks the WMS is trying to schedule */
+        void recordReadyTasks(unsigned long num_ready_tasks) {
+            this->max_ready_tasks = std::max(this->max_ready_tasks, num_ready_tasks);
+        }
+
+        std::map<std::string, double> getCounters() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        void enterWms();
+        void leaveWms();
+        unsigned long suspendWms();
+        void resumeWms(unsigned long depth);
+
+        unsigned long actors_created = 0;
+        unsigned long live_actors = 0;
+        unsigned long max_live_actors = 0;
+        unsigned long comms_started = 0;
+        unsigned long execs_started = 0;
+        unsigned long comms_completed = 0;
+        unsigned long execs_completed = 0;
+        unsigned long max_pending_comms = 0;
+        unsigned long max_pending_activities = 0;
+        unsigned long time_advances = 0;
+        unsigned long wms_events = 0;
+        unsigned long max_ready_tasks = 0;
+
+        Clock::time_point start_time;
+        double wall_time = 0.0;
+        /** @brief The nesting depth of the WmsScope's, and the start of the current WMS interval */
+        unsigned long wms_depth = 0;
+        Clock::time_point wms_start_time;
+        double wms_time = 0.0;
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_SIMULATIONPROFILER_H
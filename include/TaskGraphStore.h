@@ -0,0 +1,81 @@
+
+#ifndef WRENCH_EXAMPLE_TASKGRAPHSTORE_H
+#define WRENCH_EXAMPLE_TASKGRAPHSTORE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <wrench-dev.h>
+
+namespace wrench {
+
+    /**
+     *  @brief A compact, read-only copy of the workflow metadata built once at load time: tasks and
+     *         files get dense integer IDs, per-task attributes live in contiguous arrays, and the
+     *         parent/child/input/output relations are stored in CSR form (the neighbors of task i
+     *         are neighbors[offsets[i] .. offsets[i+1]-1]), so that the scheduler and the metrics
+     *         code do not chase shared_ptr graphs or hash strings
+     */
+    class TaskGraphStore {
+
+    public:
+        explicit TaskGraphStore(const std::shared_ptr<Workflow> &workflow);
+
+        /** @brief Get the number of tasks */
+        unsigned long getNumTasks() const { return this->tasks.size(); }
+        /** @brief Get the number of files */
+        unsigned long getNumFiles() const { return this->files.size(); }
+        /** @brief Get the number of task categories */
+        unsigned long getNumCategories() const { return this->category_names.size(); }
+
+        unsigned long getTaskIndex(const std::shared_ptr<WorkflowTask> &task) const;
+        unsigned long getTaskIndex(const std::string &task_id) const;
+        unsigned long getFileIndex(const std::shared_ptr<DataFile> &file) const;
+        long getCategoryIndex(const std::string &category_name) const;
+
+        static std::string getCategoryName(const std::string &task_id);
+
+        /** @brief The tasks, by task index */
+        std::vector<std::shared_ptr<WorkflowTask>> tasks;
+        /** @brief The files, by file index */
+        std::vector<std::shared_ptr<DataFile>> files;
+        /** @brief The category names, by category index */
+        std::vector<std::string> category_names;
+
+        /** @brief Task flops */
+        std::vector<double> task_flops;
+        /** @brief Number of bytes of the task input files */
+        std::vector<double> task_input_bytes;
+        /** @brief Number of bytes of the task output files */
+        std::vector<double> task_output_bytes;
+        /** @brief Task minimum numbers of cores */
+        std::vector<unsigned long> task_min_cores;
+        /** @brief Task maximum numbers of cores */
+        std::vector<unsigned long> task_max_cores;
+        /** @brief Task category indices */
+        std::vector<unsigned int> task_categories;
+        /** @brief File sizes, in bytes */
+        std::vector<double> file_sizes;
+
+        /** @brief CSR parents of each task */
+        std::vector<unsigned long> parent_offsets;
+        std::vector<unsigned int> parents;
+        /** @brief CSR children of each task */
+        std::vector<unsigned long> child_offsets;
+        std::vector<unsigned int> children;
+        /** @brief CSR input files of each task */
+        std::vector<unsigned long> input_offsets;
+        std::vector<unsigned int> inputs;
+        /** @brief CSR output files of each task */
+        std::vector<unsigned long> output_offsets;
+        std::vector<unsigned int> outputs;
+
+    private:
+        std::unordered_map<const WorkflowTask *, unsigned int> task_indices;
+        std::unordered_map<std::string, unsigned int> task_id_indices;
+        std::unordered_map<const DataFile *, unsigned int> file_indices;
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_TASKGRAPHSTORE_H
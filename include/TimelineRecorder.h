@@ -0,0 +1,90 @@
+
+#ifndef WRENCH_EXAMPLE_TIMELINERECORDER_H
+#define WRENCH_EXAMPLE_TIMELINERECORDER_H
+
+#include <cstdint>
+#include <queue>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AsyncWriter.h"
+
+namespace wrench {
+
+    /**
+     *  @brief A fixed-size record of the binary timeline file (read by notebooks/timeline.py)
+     */
+    struct TimelineRecord {
+        /** @brief The record type: 0 for a task execution, 1 for a host utilization interval */
+        uint8_t type = 0;
+        /** @brief Whether the task failed (task executions only) */
+        uint8_t failed = 0;
+        uint16_t reserved = 0;
+        /** @brief The host index, in the host names of the file header */
+        uint32_t host_index = 0;
+        /** @brief The task index, in the task IDs of the file header (task executions only) */
+        uint32_t task_index = 0;
+        /** @brief The cores allocated to the task, or the number of busy cores of the host during the interval */
+        uint32_t num_cores = 0;
+        double start_date = 0.0;
+        double end_date = 0.0;
+    };
+
+    static_assert(sizeof(TimelineRecord) == 32, "Unexpected padding in TimelineRecord");
+
+    /**
+     *  @brief A recorder of the Gantt chart (task executions per host and core count) and of the per-host
+     *         utilization intervals of a simulation, streamed to a compact binary file through an
+     *         AsyncWriter. Utilization intervals are emitted as soon as they can no longer change, i.e.,
+     *         before the earliest submission date of the tasks still in flight, so that memory use is
+     *         bounded by the number of running tasks rather than by the length of the timeline.
+     *
+     *  File layout (little-endian): magic "WFTL0001", u32 number of hosts, u32 number of tasks, the host
+     *  names and the task IDs (each as a u32 length followed by the bytes), zero padding to a multiple of
+     *  8 bytes, then TimelineRecord's until the end of the file.
+     */
+    class TimelineRecorder {
+
+    public:
+        TimelineRecorder(const std::string &path,
+                         const std::vector<std::string> &hostnames,
+                         const std::vector<std::string> &task_ids);
+
+        void taskSubmitted(unsigned long task_index, double date);
+        void taskEnded(unsigned long task_index, const std::string &hostname, unsigned long num_cores,
+                       double start_date, double end_date, bool failed);
+        void close();
+
+    private:
+        void emitUtilization(double until);
+
+        /** @brief A change of the number of busy cores of a host */
+        struct UtilizationChange {
+            double date;
+            long delta;
+            bool operator>(const UtilizationChange &other) const { return this->date > other.date; }
+        };
+
+        /** @brief The sweep state of a host */
+        struct HostUtilization {
+            /** @brief The changes not emitted yet, earliest first */
+            std::priority_queue<UtilizationChange, std::vector<UtilizationChange>, std::greater<>> changes;
+            /** @brief The number of busy cores since the start of the current interval */
+            long busy_cores = 0;
+            /** @brief The start of the current interval */
+            double interval_start = 0.0;
+        };
+
+        AsyncWriter<TimelineRecord> writer;
+        std::unordered_map<std::string, uint32_t> host_indices;
+        std::vector<HostUtilization> hosts;
+        /** @brief The submission dates of the tasks in flight */
+        std::multiset<double> submission_dates;
+        /** @brief The entry of each task in flight in submission_dates */
+        std::unordered_map<unsigned long, std::multiset<double>::iterator> in_flight_tasks;
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_TIMELINERECORDER_H
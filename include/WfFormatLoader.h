@@ -0,0 +1,30 @@
+
+#ifndef WRENCH_EXAMPLE_WFFORMATLOADER_H
+#define WRENCH_EXAMPLE_WFFORMATLOADER_H
+
+#include <string>
+
+#include <wrench-dev.h>
+
+namespace wrench {
+
+    /**
+     *  @brief A fast loader of WfFormat 1.5 workflows (as generated by WfCommons), based on the
+     *         simdjson On-Demand parser: task and file IDs are read as string views into the parser
+     *         buffers, and the Workflow is constructed directly from the specification and
+     *         execution arrays, without an intermediate JSON tree
+     *
+     *  Task flops are runtimeInSeconds times the reference flop rate (machine specifications are
+     *  ignored), tasks use the coreCount of their execution (1 by default), and avgCPU/readBytes/writtenBytes are kept as task metadata.
+     */
+    class WfFormatLoader {
+
+    public:
+        static std::shared_ptr<Workflow> createWorkflowFromJSON(const std::string &filename,
+                                                               const std::string &reference_flop_rate);
+
+        static bool isAvailable();
+    };
+
+}// namespace wrench
+#endif//WRENCH_EXAMPLE_WFFORMATLOADER_H
@@ -0,0 +1,85 @@
+import struct
+from collections import namedtuple
+
+import numpy as np
+
+# Reader of the binary timeline files written by the simulator with --timeline=<file>
+# (see include/TimelineRecorder.h for the layout).
+#
+#   from timeline import read_timeline, to_dataframes
+#   timeline = read_timeline('../datas/timeline.bin')
+#   tasks, utilization = to_dataframes(timeline)
+
+MAGIC = b'WFTL0001'
+
+TASK_EXECUTION = 0
+HOST_UTILIZATION = 1
+
+RECORD_DTYPE = np.dtype([
+    ('type', '<u1'),
+    ('failed', '<u1'),
+    ('reserved', '<u2'),
+    ('host_index', '<u4'),
+    ('task_index', '<u4'),
+    ('num_cores', '<u4'),
+    ('start_date', '<f8'),
+    ('end_date', '<f8'),
+])
+
+Timeline = namedtuple('Timeline', ['hosts', 'tasks', 'task_executions', 'host_utilization'])
+
+
+def read_header(path):
+    """Return the host names, the task IDs and the offset of the first record."""
+    with open(path, 'rb') as timeline_file:
+        if timeline_file.read(8) != MAGIC:
+            raise ValueError(f'{path} is not a timeline file')
+        num_hosts, num_tasks = struct.unpack('<II', timeline_file.read(8))
+        names = []
+        for _ in range(num_hosts + num_tasks):
+            length, = struct.unpack('<I', timeline_file.read(4))
+            names.append(timeline_file.read(length).decode())
+        offset = timeline_file.tell()
+    return names[:num_hosts], names[num_hosts:], offset + (-offset % 8)
+
+
+def iter_records(path, chunk_size=1 << 20):
+    """Yield the records of a timeline file in chunks, without loading the whole file."""
+    _, _, offset = read_header(path)
+    records = np.memmap(path, dtype=RECORD_DTYPE, mode='r', offset=offset)
+    for start in range(0, len(records), chunk_size):
+        yield records[start:start + chunk_size]
+
+
+def read_timeline(path):
+    """Read a timeline file; the record arrays are memory-mapped."""
+    hosts, tasks, offset = read_header(path)
+    records = np.memmap(path, dtype=RECORD_DTYPE, mode='r', offset=offset)
+    return Timeline(hosts, tasks,
+                    records[records['type'] == TASK_EXECUTION],
+                    records[records['type'] == HOST_UTILIZATION])
+
+
+def to_dataframes(timeline):
+    """Return the task executions (Gantt chart) and the host utilization intervals as pandas DataFrames."""
+    import pandas as pd
+
+    hosts = np.array(timeline.hosts, dtype=object)
+    tasks = np.array(timeline.tasks, dtype=object)
+    executions = timeline.task_executions
+    task_executions = pd.DataFrame({
+        'task_id': tasks[executions['task_index']],
+        'host_name': hosts[executions['host_index']],
+        'num_cores': executions['num_cores'],
+        'start_date': executions['start_date'],
+        'end_date': executions['end_date'],
+        'failed': executions['failed'].astype(bool),
+    })
+    utilization = timeline.host_utilization
+    host_utilization = pd.DataFrame({
+        'host_name': hosts[utilization['host_index']],
+        'busy_cores': utilization['num_cores'],
+        'start_date': utilization['start_date'],
+        'end_date': utilization['end_date'],
+    })
+    return task_executions, host_utilization
@@ -0,0 +1,214 @@
+import argparse
+import pathlib
+import re
+import sys
+
+# Generates the Apollo 2000 platform description (apollo_2000_platform.xml) and its variants.
+# Without options the output matches the hand-written platform: 30 batch nodes, 3 cloud nodes,
+# the WMS host with the shared storage and a single backbone link.
+
+parser = argparse.ArgumentParser(description='Generate a SimGrid platform file for the Apollo 2000 cluster')
+parser.add_argument('--output', default=str(pathlib.Path(__file__).parent / 'apollo_2000_platform.xml'),
+                    help='path of the generated XML file')
+parser.add_argument('--batch-nodes', type=int, default=30, help='number of compute nodes behind the batch service')
+parser.add_argument('--cloud-nodes', type=int, default=3, help='number of nodes behind the cloud service')
+parser.add_argument('--cores', type=int, default=28, help='cores per CPU node')
+parser.add_argument('--speed', default='1Gf', help='per-core speed of the CPU nodes')
+parser.add_argument('--wattage', default='50.00:250.00:800.00',
+                    help='idle:one-core:all-cores wattage of the CPU nodes')
+parser.add_argument('--pstates',
+                    help='comma-separated pstates of the CPU nodes as <speed>@<idle>:<one-core>:<all-cores>, fastest first '
+                         '(overrides --speed and --wattage)')
+parser.add_argument('--dvfs-levels', type=int, default=1,
+                    help='number of pstates derived from --speed and --wattage, evenly spaced down to --dvfs-min-ratio '
+                         'of the speed, with a dynamic power proportional to speed^--dvfs-exponent')
+parser.add_argument('--dvfs-min-ratio', type=float, default=0.5, help='speed ratio of the slowest derived pstate')
+parser.add_argument('--dvfs-exponent', type=float, default=3.0,
+                    help='exponent of the dynamic power of the derived pstates (3 when the voltage scales with the frequency)')
+parser.add_argument('--sleep-wattage',
+                    help='power of a powered-down batch node, in Watts; adds a sleep pstate (the last one) to the batch '
+                         'nodes, which the WMS uses for the nodes no pilot job runs on')
+parser.add_argument('--boot-time', type=float, default=120.0,
+                    help='time for a powered-down batch node to become usable, in seconds (at the idle power of the '
+                         'first pstate)')
+parser.add_argument('--sockets', type=int, default=1,
+                    help='CPU sockets per CPU node, sharing its cores evenly (2 for the two 14-core CPUs of the Apollo '
+                         'nodes); used by the socket-aware power model of the simulator')
+parser.add_argument('--socket-gated-wattage',
+                    help='power of a CPU socket with no busy core, which is then power-gated, in Watts (by default '
+                         'idle sockets draw their share of the idle power)')
+parser.add_argument('--turbo-speed',
+                    help='per-core speed of a turbo pstate of the CPU nodes (after the nominal ones), which the simulator '
+                         'selects while at most --turbo-max-cores cores of a node are busy')
+parser.add_argument('--turbo-wattage', default='50.00:320.00:1100.00',
+                    help='idle:one-core:all-cores wattage of the turbo pstate')
+parser.add_argument('--turbo-max-cores', type=int, default=4, help='maximum number of busy cores of a node in turbo')
+parser.add_argument('--cstate-wakeup-latency', type=float,
+                    help='time for an idle CPU socket to leave its deep C-state when a task starts on it, in seconds')
+parser.add_argument('--memory-bandwidth', type=float,
+                    help='memory bandwidth of the CPU nodes, in GB/s; the interference model of the simulator rates the '
+                         'memory intensity of the tasks against it')
+parser.add_argument('--disk-read-bandwidth', default='100MBps', help='read bandwidth of the shared storage disk')
+parser.add_argument('--disk-write-bandwidth', default='100MBps', help='write bandwidth of the shared storage disk')
+parser.add_argument('--link-bandwidth', default='10000MBps', help='bandwidth of the backbone link')
+parser.add_argument('--accelerator-nodes', type=int, default=0,
+                    help='number of accelerator-equipped nodes (AccelNode1..N)')
+parser.add_argument('--accelerator-cores', type=int, default=4,
+                    help='concurrent accelerated tasks per accelerator node')
+parser.add_argument('--accelerator-speed', default='10Gf',
+                    help='per-slot speed of the accelerator nodes (the best-case speedup over the CPU nodes)')
+parser.add_argument('--accelerator-wattage', default='120.00:450.00:1300.00',
+                    help='idle:one-slot:all-slots wattage of the accelerator nodes')
+args = parser.parse_args()
+
+
+UNITS = {'': 1, 'k': 1e3, 'M': 1e6, 'G': 1e9, 'T': 1e12, 'P': 1e15}
+
+
+def parse_speed(speed):
+    match = re.fullmatch(r'([0-9.eE+-]+)\s*([kMGTP]?)f', speed.strip())
+    if not match:
+        sys.exit(f'Invalid speed {speed}')
+    return float(match.group(1)) * UNITS[match.group(2)]
+
+
+def cpu_pstates():
+    """The (speed, wattage) of each pstate of the CPU nodes, fastest first."""
+    if args.pstates:
+        pstates = []
+        for entry in args.pstates.split(','):
+            speed, _, wattage = entry.partition('@')
+            if len(wattage.split(':')) != 3:
+                sys.exit(f'Invalid pstate {entry}: expected <speed>@<idle>:<one-core>:<all-cores>')
+            pstates.append((speed.strip(), wattage.strip()))
+        return pstates
+    if args.dvfs_levels <= 1:
+        return [(args.speed, args.wattage)]
+    # Idle power is static; the power above it scales with speed^exponent
+    base_speed = parse_speed(args.speed)
+    idle, one_core, all_cores = (float(w) for w in args.wattage.split(':'))
+    pstates = []
+    for level in range(args.dvfs_levels):
+        ratio = 1.0 - (1.0 - args.dvfs_min_ratio) * level / (args.dvfs_levels - 1)
+        scale = ratio ** args.dvfs_exponent
+        pstates.append((f'{base_speed * ratio / 1e9:g}Gf',
+                        f'{idle:.2f}:{idle + (one_core - idle) * scale:.2f}:{idle + (all_cores - idle) * scale:.2f}'))
+    return pstates
+
+
+pstates = cpu_pstates()
+nominal_pstates = list(pstates)
+# The turbo pstate follows the nominal ones (it is never the initial pstate of a node)
+turbo_props = ''
+if args.turbo_speed is not None:
+    if len(args.turbo_wattage.split(':')) != 3:
+        sys.exit(f'Invalid turbo wattage {args.turbo_wattage}: expected <idle>:<one-core>:<all-cores>')
+    pstates.append((args.turbo_speed, args.turbo_wattage))
+    turbo_props = (f'            <prop id="turbo_pstate" value="{len(pstates) - 1}"/>\n'
+                   f'            <prop id="turbo_max_cores" value="{args.turbo_max_cores}"/>\n')
+cpu_speed = ','.join(speed for speed, _ in pstates)
+cpu_wattage = ', '.join(wattage for _, wattage in pstates)
+
+# Powered-down batch nodes are modeled as an extra pstate that computes (almost) nothing
+batch_speed, batch_wattage, batch_props = cpu_speed, cpu_wattage, ''
+if args.sleep_wattage is not None:
+    sleep_speed = parse_speed(nominal_pstates[-1][0]) * 1e-6
+    batch_speed += f',{sleep_speed / 1e9:g}Gf'
+    batch_wattage += f', {float(args.sleep_wattage):.2f}:{float(args.sleep_wattage):.2f}:{float(args.sleep_wattage):.2f}'
+    batch_props = (f'            <prop id="sleep_pstate" value="{len(pstates)}"/>\n'
+                   f'            <prop id="boot_time" value="{args.boot_time:g}"/>\n')
+
+
+def host(host_id, speed, cores, ram, wattage, node_class=None, extra=''):
+    props = f'            <prop id="ram" value="{ram}"/>\n'
+    if node_class:
+        props += f'            <prop id="node_class" value="{node_class}"/>\n'
+    props += extra
+    props += f'            <prop id="wattage_per_state" value="{wattage}"/>\n'
+    return f'        <host id="{host_id}" speed="{speed}" core="{cores}">\n{props}        </host>\n\n'
+
+
+def route(src, dst):
+    return f'        <route src="{src}" dst="{dst}"><link_ctn id="backbone"/></route>\n'
+
+
+batch_nodes = [f'Node{i}' for i in range(1, args.batch_nodes + 1)]
+cloud_nodes = [f'CloudNode{i}' for i in range(1, args.cloud_nodes + 1)]
+if args.cores % args.sockets != 0:
+    sys.exit(f'{args.cores} cores cannot be shared evenly by {args.sockets} sockets')
+accelerator_nodes = [f'AccelNode{i}' for i in range(1, args.accelerator_nodes + 1)]
+
+total_nodes = 1 + len(batch_nodes)
+xml = "<?xml version='1.0'?>\n"
+xml += '<!DOCTYPE platform SYSTEM "https://simgrid.org/simgrid.dtd">\n'
+xml += '<platform version="4.1">\n'
+xml += '    <zone id="AS0" routing="Full">\n\n'
+xml += '        <!-- COMPUTATIONAL NODES - APOLLO 2000 -->\n'
+xml += f'        <!-- Cada nó tem {args.cores} cores (2 CPUs de {args.cores // 2} cores) e 109.42 GB de RAM -->\n'
+xml += f'        <!-- Total: {total_nodes} nós * {args.cores} cores = {total_nodes * args.cores} cores -->\n\n'
+
+# Socket topology, turbo and C-states of the CPU nodes
+socket_props = turbo_props
+if args.sockets > 1:
+    socket_props += f'            <prop id="sockets" value="{args.sockets}"/>\n'
+if args.socket_gated_wattage is not None:
+    socket_props += f'            <prop id="socket_gated_wattage" value="{float(args.socket_gated_wattage):.2f}"/>\n'
+if args.cstate_wakeup_latency is not None:
+    socket_props += f'            <prop id="cstate_wakeup_latency" value="{args.cstate_wakeup_latency:g}"/>\n'
+if args.memory_bandwidth is not None:
+    socket_props += f'            <prop id="memory_bandwidth" value="{args.memory_bandwidth * 1e9:g}"/>\n'
+
+xml += host('BatchHeadNode', cpu_speed, args.cores, '109.42GB', cpu_wattage, extra=socket_props)
+for node in batch_nodes:
+    xml += host(node, batch_speed, args.cores, '109.42GB', batch_wattage, extra=batch_props + socket_props)
+
+xml += '        <!-- WMS HOST -->\n'
+xml += (f'        <host id="WMSHost" speed="{cpu_speed}" core="{args.cores}">\n'
+        '            <prop id="ram" value="256GB"/>\n'
+        f'            <disk id="storage" read_bw="{args.disk_read_bandwidth}" write_bw="{args.disk_write_bandwidth}">\n'
+        '                <prop id="size" value="156TiB"/>\n'
+        '                <prop id="mount" value="/"/>\n'
+        '            </disk>\n'
+        f'            <prop id="wattage_per_state" value="{cpu_wattage}"/>\n'
+        '        </host>\n\n')
+
+xml += '        <!-- CLOUD NODES -->\n'
+xml += host('CloudHeadNode', cpu_speed, args.cores, '128GB', cpu_wattage, extra=socket_props)
+for node in cloud_nodes:
+    xml += host(node, cpu_speed, args.cores, '128GB', cpu_wattage, extra=socket_props)
+
+if accelerator_nodes:
+    # Accelerators are simulated as fast hosts with their own power profile; each "core" is one
+    # accelerator slot that runs a single task at the accelerator speed.
+    xml += '        <!-- ACCELERATOR NODES -->\n'
+    for node in accelerator_nodes:
+        xml += host(node, args.accelerator_speed, args.accelerator_cores, '128GB', args.accelerator_wattage,
+                    node_class='accelerator')
+
+xml += '        <!-- Link de rede -->\n'
+xml += f'        <link id="backbone" bandwidth="{args.link_bandwidth}" latency="0.5ms"/>\n\n'
+
+xml += '        <!-- Rotas entre todos os nós -->\n'
+for node in ['BatchHeadNode'] + batch_nodes:
+    xml += route('WMSHost', node)
+xml += '\n'
+for node in ['CloudHeadNode'] + cloud_nodes:
+    xml += route('WMSHost', node)
+xml += '\n'
+if accelerator_nodes:
+    for node in accelerator_nodes:
+        xml += route('WMSHost', node)
+    xml += '\n'
+for node in batch_nodes:
+    xml += route('BatchHeadNode', node)
+xml += '\n'
+for node in cloud_nodes:
+    xml += route('CloudHeadNode', node)
+xml += '\n'
+xml += '    </zone>\n'
+xml += '</platform>\n'
+
+output_path = pathlib.Path(args.output)
+output_path.parent.mkdir(parents=True, exist_ok=True)
+output_path.write_text(xml)
+print(f'Platform written to {output_path}')
@@ -0,0 +1,127 @@
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "AsyncWriter.h"
+
+namespace wrench {
+
+    /**
+     * @brief Constructor
+     *
+     * @param path: the path of the output file
+     * @param append: whether to append to the file rather than truncating it
+     * @param compress: whether to zstd-compress what is written (appended frames are valid zstd streams)
+     *
+     * @throw std::runtime_error
+     */
+    OutputSink::OutputSink(const std::string &path, bool append, bool compress) : path(path) {
+#ifndef ENABLE_ZSTD
+        if (compress) {
+            throw std::runtime_error("OutputSink::OutputSink(): Compression requested for " + path +
+                                     " but the simulator was built without zstd");
+        }
+#endif
+        this->file = fopen(path.c_str(), append ? "ab" : "wb");
+        if (this->file == nullptr) {
+            throw std::runtime_error("OutputSink::OutputSink(): Cannot open " + path + ": " + strerror(errno));
+        }
+        fseek(this->file, 0, SEEK_END);
+        this->was_empty = (ftell(this->file) == 0);
+#ifdef ENABLE_ZSTD
+        if (compress) {
+            this->compression_context = ZSTD_createCCtx();
+            this->compression_buffer.resize(ZSTD_CStreamOutSize());
+        }
+#endif
+    }
+
+    OutputSink::~OutputSink() {
+        this->close();
+    }
+
+    /**
+     * @brief Record a write error (only the first one is kept)
+     *
+     * @param message: the cause of the error
+     */
+    void OutputSink::fail(const std::string &message) {
+        if (this->error.empty()) {
+            this->error = "Cannot write " + this->path + ": " + message;
+        }
+    }
+
+    /**
+     * @brief Write (and compress, if requested) data to the output file
+     *
+     * @param data: the data
+     */
+    void OutputSink::write(const std::string &data) {
+        if (this->file == nullptr or data.empty() or not this->error.empty()) {
+            return;
+        }
+#ifdef ENABLE_ZSTD
+        if (this->compression_context) {
+            auto context = static_cast<ZSTD_CCtx *>(this->compression_context);
+            ZSTD_inBuffer input = {data.data(), data.size(), 0};
+            while (input.pos < input.size) {
+                ZSTD_outBuffer output = {this->compression_buffer.data(), this->compression_buffer.size(), 0};
+                size_t result = ZSTD_compressStream2(context, &output, &input, ZSTD_e_continue);
+                if (ZSTD_isError(result)) {
+                    fail(ZSTD_getErrorName(result));
+                    return;
+                }
+                if (fwrite(output.dst, 1, output.pos, this->file) != output.pos) {
+                    fail(strerror(errno));
+                    return;
+                }
+            }
+            return;
+        }
+#endif
+        if (fwrite(data.data(), 1, data.size(), this->file) != data.size()) {
+            fail(strerror(errno));
+        }
+    }
+
+    /**
+     * @brief End the compressed frame, if any, and close the output file (errors are recorded, see getError())
+     */
+    void OutputSink::close() {
+        if (this->file == nullptr) {
+            return;
+        }
+#ifdef ENABLE_ZSTD
+        if (this->compression_context) {
+            auto context = static_cast<ZSTD_CCtx *>(this->compression_context);
+            ZSTD_inBuffer input = {nullptr, 0, 0};
+            size_t remaining = 0;
+            do {
+                if (not this->error.empty()) {
+                    break;
+                }
+                ZSTD_outBuffer output = {this->compression_buffer.data(), this->compression_buffer.size(), 0};
+                remaining = ZSTD_compressStream2(context, &output, &input, ZSTD_e_end);
+                if (ZSTD_isError(remaining)) {
+                    fail(ZSTD_getErrorName(remaining));
+                } else if (fwrite(output.dst, 1, output.pos, this->file) != output.pos) {
+                    fail(strerror(errno));
+                }
+            } while (remaining > 0);
+            ZSTD_freeCCtx(context);
+            this->compression_context = nullptr;
+        }
+#endif
+        // Buffered data is written by fclose(), which can fail as well (e.g., on a full disk)
+        if (fclose(this->file) != 0) {
+            fail(strerror(errno));
+        }
+        this->file = nullptr;
+    }
+
+}// namespace wrench
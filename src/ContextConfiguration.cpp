@@ -0,0 +1,176 @@
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include "ContextConfiguration.h"
+#include "RecipeRepository.h"
+
+namespace wrench {
+
+    /**
+     * @brief Count the tasks of a workflow without loading it: WfFormat (1.4 and 1.5) gives the
+     *        "parents" of every task exactly once, so their occurrences are counted in the raw file
+     *
+     * @param workflow: the workflow file, or the key of a packed recipe
+     * @param recipe_repository: the packed recipe file the key refers to (empty if none)
+     * @return the number of tasks (0 if the workflow cannot be read, which SimGrid defaults then handle)
+     */
+    unsigned long ContextConfiguration::countTasks(const std::string &workflow, const std::string &recipe_repository) {
+        if (not recipe_repository.empty()) {
+            try {
+                RecipeRepository repository(recipe_repository);
+                for (auto const &entry: repository.getEntries()) {
+                    if (RecipeRepository::getKey(entry) == workflow) {
+                        return entry.num_tasks;
+                    }
+                }
+            } catch (std::exception &) {
+            }
+            return 0;
+        }
+
+        FILE *file = fopen(workflow.c_str(), "rb");
+        if (file == nullptr) {
+            return 0;
+        }
+        static const char pattern[] = "\"parents\"";
+        const size_t pattern_length = sizeof(pattern) - 1;
+        std::vector<char> buffer(1 << 20);
+        size_t carry = 0;
+        unsigned long num_tasks = 0;
+        size_t length;
+        while ((length = fread(buffer.data() + carry, 1, buffer.size() - carry, file)) > 0) {
+            length += carry;
+            const char *position = buffer.data();
+            const char *end = buffer.data() + length;
+            while ((position = static_cast<const char *>(memchr(position, '"', end - position))) != nullptr) {
+                if ((size_t) (end - position) < pattern_length) {
+                    break;
+                }
+                if (memcmp(position, pattern, pattern_length) == 0) {
+                    num_tasks++;
+                    position += pattern_length;
+                } else {
+                    position++;
+                }
+            }
+            // A pattern may straddle two reads
+            carry = std::min(length, pattern_length - 1);
+            memmove(buffer.data(), end - carry, carry);
+        }
+        fclose(file);
+        return num_tasks;
+    }
+
+    /**
+     * @brief Select the actor stack size for a workflow size
+     *
+     * @param num_tasks: the number of tasks of the workflow
+     * @return a stack size, in KiB
+     */
+    unsigned long ContextConfiguration::selectStackSize(unsigned long num_tasks) {
+        if (num_tasks >= 50000) {
+            return 512;
+        }
+        if (num_tasks >= 10000) {
+            return 1024;
+        }
+        return default_stack_size;
+    }
+
+    /**
+     * @brief Select the number of worker threads that run the actors for a workflow size
+     *
+     * @param num_tasks: the number of tasks of the workflow
+     * @param hardware_threads: the number of hardware threads of the machine (0 if unknown)
+     * @return a number of threads (1 to run the actors sequentially)
+     */
+    unsigned long ContextConfiguration::selectNumThreads(unsigned long num_tasks, unsigned long hardware_threads) {
+        if (num_tasks < 10000) {
+            return 1;
+        }
+        return std::max(1UL, std::min(hardware_threads, max_auto_threads));
+    }
+
+    /**
+     * @brief Get the SimGrid configuration arguments of a run
+     *
+     * @param num_tasks: the number of tasks of the workflow
+     * @param factory: the context backend ("auto" or empty to leave it to SimGrid)
+     * @param stack_size: the actor stack size in KiB ("auto" or empty to select it from the workflow size)
+     * @param threads: the number of worker threads ("auto" to select it from the workflow size, empty to
+     *        run the actors sequentially)
+     * @param parallel_threshold: the minimum number of ready actors for a round to run in parallel (empty
+     *        for the default)
+     * @param arguments: the command-line arguments, whose --cfg=contexts/... settings take precedence
+     * @return --cfg=... arguments
+     *
+     * @throw std::invalid_argument
+     */
+    std::vector<std::string> ContextConfiguration::getConfigArguments(unsigned long num_tasks,
+                                                                     const std::string &factory,
+                                                                     const std::string &stack_size,
+                                                                     const std::string &threads,
+                                                                     const std::string &parallel_threshold,
+                                                                     const std::vector<std::string> &arguments) {
+        auto configured = [&arguments](const std::string &name) {
+            return std::any_of(arguments.begin(), arguments.end(), [&name](const std::string &argument) {
+                return argument.rfind("--cfg=" + name + ":", 0) == 0;
+            });
+        };
+        std::vector<std::string> config_arguments;
+        if (not factory.empty() and factory != "auto" and not configured("contexts/factory")) {
+            if (factory != "raw" and factory != "ucontext" and factory != "thread" and factory != "boost") {
+                throw std::invalid_argument("ContextConfiguration::getConfigArguments(): Unknown context factory " + factory);
+            }
+            config_arguments.push_back("--cfg=contexts/factory:" + factory);
+        }
+        unsigned long stack_size_kib = selectStackSize(num_tasks);
+        if (not stack_size.empty() and stack_size != "auto") {
+            try {
+                stack_size_kib = std::stoul(stack_size);
+            } catch (std::exception &) {
+                throw std::invalid_argument("ContextConfiguration::getConfigArguments(): Invalid stack size " + stack_size);
+            }
+        }
+        if (stack_size_kib != default_stack_size and not configured("contexts/stack-size")) {
+            config_arguments.push_back("--cfg=contexts/stack-size:" + std::to_string(stack_size_kib));
+        }
+
+        unsigned long num_threads = 1;
+        if (threads == "auto") {
+            num_threads = selectNumThreads(num_tasks, std::thread::hardware_concurrency());
+        } else if (not threads.empty()) {
+            try {
+                num_threads = std::stoul(threads);
+            } catch (std::exception &) {
+                num_threads = 0;
+            }
+            if (num_threads == 0) {
+                throw std::invalid_argument("ContextConfiguration::getConfigArguments(): Invalid number of threads " + threads);
+            }
+        }
+        unsigned long threshold = default_parallel_threshold;
+        if (not parallel_threshold.empty()) {
+            try {
+                threshold = std::stoul(parallel_threshold);
+            } catch (std::exception &) {
+                threshold = 0;
+            }
+            if (threshold == 0) {
+                throw std::invalid_argument("ContextConfiguration::getConfigArguments(): Invalid parallel threshold " + parallel_threshold);
+            }
+        }
+        if (num_threads > 1 and not configured("contexts/nthreads")) {
+            config_arguments.push_back("--cfg=contexts/nthreads:" + std::to_string(num_threads));
+            if (not configured("contexts/parallel-threshold")) {
+                config_arguments.push_back("--cfg=contexts/parallel-threshold:" + std::to_string(threshold));
+            }
+        }
+        return config_arguments;
+    }
+
+}// namespace wrench
@@ -0,0 +1,135 @@
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "DecisionLog.h"
+
+namespace wrench {
+
+    /**
+     * @brief Constructor
+     *
+     * @param path: the path of the decision log to write (empty for none)
+     * @param baseline_path: the path of the decision log of a baseline run to compare with (empty for none)
+     *
+     * @throw std::runtime_error
+     * @throw std::invalid_argument
+     */
+    DecisionLog::DecisionLog(const std::string &path, const std::string &baseline_path) {
+        if (not baseline_path.empty()) {
+            this->baseline = readDecisions(baseline_path);
+            this->has_baseline = true;
+        }
+        if (not path.empty()) {
+            this->writer = std::make_unique<AsyncWriter<Decision>>(
+                    path,
+                    [index = 0UL](const Decision &decision, std::string &out) mutable {
+                        // Dates are written with full precision, so that logs compare exactly
+                        char date[32];
+                        snprintf(date, sizeof(date), "%.17g", decision.date);
+                        out += std::to_string(index++) + "," + date + "," + decision.kind + "," + decision.subject + "," +
+                               decision.target + "\n";
+                    },
+                    false, false, "index,date,kind,subject,target\n");
+        }
+    }
+
+    /**
+     * @brief Record a decision, and compare it with the decision of the baseline run at the same index
+     *
+     * @param decision: a decision
+     * @return true if the run has diverged from the baseline (at this decision or before)
+     */
+    bool DecisionLog::record(const Decision &decision) {
+        if (this->writer) {
+            this->writer->write(decision);
+        }
+        if (this->has_baseline and this->first_divergence < 0) {
+            bool same = this->num_decisions < this->baseline.size();
+            if (same) {
+                auto const &expected = this->baseline[this->num_decisions];
+                same = expected.kind == decision.kind and expected.subject == decision.subject and
+                       expected.target == decision.target and
+                       std::fabs(expected.date - decision.date) <= 1e-9 * std::max(1.0, std::fabs(expected.date));
+            }
+            if (not same) {
+                this->first_divergence = (long) this->num_decisions;
+                this->first_divergence_date = decision.date;
+            }
+        }
+        this->num_decisions++;
+        this->last_date = decision.date;
+        return this->first_divergence >= 0;
+    }
+
+    /**
+     * @brief Wait for all decisions to be written, and close the decision log
+     *
+     * @throw std::runtime_error
+     */
+    void DecisionLog::close() {
+        if (this->writer) {
+            this->writer->close();
+        }
+    }
+
+    /**
+     * @brief Get the index of the first decision that differs from the baseline, counting a run that
+     *        stops before making all the decisions of the baseline as diverging after its last decision
+     *
+     * @return a decision index, or -1 if the run matches the baseline so far
+     */
+    long DecisionLog::getFirstDivergence() const {
+        if (this->first_divergence < 0 and this->has_baseline and this->num_decisions < this->baseline.size()) {
+            return (long) this->num_decisions;
+        }
+        return this->first_divergence;
+    }
+
+    /**
+     * @brief Get the date of the first decision that differs from the baseline
+     *
+     * @return a date, or -1 if the run matches the baseline so far
+     */
+    double DecisionLog::getFirstDivergenceDate() const {
+        if (this->first_divergence < 0 and this->has_baseline and this->num_decisions < this->baseline.size()) {
+            return this->last_date;
+        }
+        return this->first_divergence_date;
+    }
+
+    /**
+     * @brief Read a decision log
+     *
+     * @param path: the path of the decision log
+     * @return the decisions, in order
+     *
+     * @throw std::invalid_argument
+     */
+    std::vector<Decision> DecisionLog::readDecisions(const std::string &path) {
+        std::ifstream file(path);
+        if (not file.is_open()) {
+            throw std::invalid_argument("DecisionLog::readDecisions(): Cannot open " + path);
+        }
+        std::vector<Decision> decisions;
+        std::string line;
+        std::getline(file, line);
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            std::string index, date;
+            Decision decision;
+            if (not std::getline(fields, index, ',') or not std::getline(fields, date, ',') or
+                not std::getline(fields, decision.kind, ',') or not std::getline(fields, decision.subject, ',') or
+                not std::getline(fields, decision.target)) {
+                throw std::invalid_argument("DecisionLog::readDecisions(): Invalid line in " + path + ": " + line);
+            }
+            decision.date = std::stod(date);
+            decisions.push_back(decision);
+        }
+        return decisions;
+    }
+
+}// namespace wrench
@@ -0,0 +1,144 @@
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "EnergyKernel.h"
+
+namespace wrench {
+
+    /**
+     * @brief Constructor, which turns utilization intervals and pstate changes into per-host power
+     *        timelines that cover [0, horizon]
+     *
+     * @param hostnames: the names of the hosts
+     * @param pstate_profiles: for each host, the power profile of each of its pstates
+     * @param intervals: the periods during which cores were busy computing
+     * @param pstate_changes: the pstate changes of the hosts (hosts start in pstate 0)
+     * @param horizon: the date at which the timelines end
+     * @param consolidated_sockets: whether the busy cores of multi-socket hosts are consolidated onto
+     *        as few sockets as possible (rather than spread evenly over the sockets)
+     *
+     * @throw std::invalid_argument
+     */
+    PowerTimelines::PowerTimelines(std::vector<std::string> hostnames,
+                                   const std::vector<std::vector<HostPowerProfile>> &pstate_profiles,
+                                   std::vector<UtilizationInterval> intervals,
+                                   std::vector<PstateChange> pstate_changes,
+                                   double horizon,
+                                   bool consolidated_sockets) : hostnames(std::move(hostnames)), horizon(horizon) {
+        if (pstate_profiles.size() != this->hostnames.size()) {
+            throw std::invalid_argument("PowerTimelines::PowerTimelines(): One list of pstate profiles per host is required");
+        }
+
+        // A utilization change is a signed number of cores (with pstate -1), a pstate change has no core delta
+        struct Event {
+            unsigned long host;
+            double date;
+            long core_delta;
+            long pstate;
+        };
+        std::vector<Event> events;
+        events.reserve(2 * intervals.size() + pstate_changes.size());
+        for (auto const &interval: intervals) {
+            events.push_back({interval.host, interval.start_date, (long) interval.num_cores, -1});
+            events.push_back({interval.host, interval.end_date, -(long) interval.num_cores, -1});
+        }
+        for (auto const &change: pstate_changes) {
+            events.push_back({change.host, change.date, 0, (long) change.pstate});
+        }
+        // At equal dates, pstate changes come first, then the cores that become busy, then those that are released,
+        // so that the busy core count never goes negative (zero-length intervals included)
+        auto rank = [](const Event &event) { return (event.pstate >= 0) ? 0 : ((event.core_delta > 0) ? 1 : 2); };
+        std::sort(events.begin(), events.end(), [&rank](const Event &a, const Event &b) {
+            if (a.host != b.host) {
+                return a.host < b.host;
+            }
+            return (a.date != b.date) ? (a.date < b.date) : (rank(a) < rank(b));
+        });
+
+        this->offsets.reserve(this->hostnames.size() + 1);
+        auto event = events.begin();
+        for (unsigned long host = 0; host < this->hostnames.size(); host++) {
+            this->offsets.push_back(this->powers.size());
+            auto const &profiles = pstate_profiles[host];
+            double segment_start = 0.0;
+            long busy_cores = 0;
+            unsigned long pstate = 0;
+            for (; event != events.end() and event->host == host; ++event) {
+                if (event->date > segment_start and segment_start < horizon) {
+                    this->start_dates.push_back(segment_start);
+                    this->end_dates.push_back(std::min(event->date, horizon));
+                    this->powers.push_back(profiles.at(pstate).getPower(busy_cores, consolidated_sockets));
+                    segment_start = event->date;
+                }
+                if (event->pstate >= 0) {
+                    pstate = std::min<unsigned long>(event->pstate, profiles.size() - 1);
+                } else {
+                    busy_cores += event->core_delta;
+                }
+            }
+            if (horizon > segment_start) {
+                this->start_dates.push_back(segment_start);
+                this->end_dates.push_back(horizon);
+                this->powers.push_back(profiles.at(pstate).getPower(busy_cores, consolidated_sockets));
+            }
+        }
+        this->offsets.push_back(this->powers.size());
+    }
+
+    /**
+     * @brief Compute the energy, average power, peak power and power histogram of each host over a
+     *        time window. The loop over the segments of a host is branch-free so that it vectorizes.
+     *
+     * @param window_start: the start date of the window
+     * @param window_end: the end date of the window
+     * @param histogram_edges: increasing power bin edges, in Watts (no histogram if fewer than 2)
+     * @return the energy report of the window
+     */
+    EnergyWindowReport PowerTimelines::integrate(double window_start, double window_end,
+                                                 const std::vector<double> &histogram_edges) const {
+        EnergyWindowReport report;
+        report.window_start = window_start;
+        report.window_end = window_end;
+        report.histogram_edges = histogram_edges;
+        auto num_hosts = this->hostnames.size();
+        auto num_bins = (histogram_edges.size() > 1) ? histogram_edges.size() - 1 : 0;
+        report.energy.resize(num_hosts, 0.0);
+        report.average_power.resize(num_hosts, 0.0);
+        report.peak_power.resize(num_hosts, 0.0);
+        report.histogram.resize(num_hosts * num_bins, 0.0);
+
+        const double *start_dates = this->start_dates.data();
+        const double *end_dates = this->end_dates.data();
+        const double *powers = this->powers.data();
+        double window_length = window_end - window_start;
+
+        for (unsigned long host = 0; host < num_hosts; host++) {
+            double energy = 0.0;
+            double peak_power = 0.0;
+            auto first = this->offsets[host];
+            auto last = this->offsets[host + 1];
+#pragma omp simd reduction(+ : energy) reduction(max : peak_power)
+            for (auto i = first; i < last; i++) {
+                double overlap = std::max(0.0, std::min(end_dates[i], window_end) - std::max(start_dates[i], window_start));
+                energy += powers[i] * overlap;
+                peak_power = std::max(peak_power, (overlap > 0.0) ? powers[i] : 0.0);
+            }
+            report.energy[host] = energy;
+            report.peak_power[host] = peak_power;
+            report.average_power[host] = (window_length > 0.0) ? energy / window_length : 0.0;
+
+            if (num_bins > 0) {
+                double *bins = report.histogram.data() + host * num_bins;
+                for (auto i = first; i < last; i++) {
+                    double overlap = std::max(0.0, std::min(end_dates[i], window_end) - std::max(start_dates[i], window_start));
+                    auto edge = std::upper_bound(histogram_edges.begin(), histogram_edges.end(), powers[i]);
+                    auto bin = std::min<long>(std::max<long>(edge - histogram_edges.begin() - 1, 0), (long) num_bins - 1);
+                    bins[bin] += overlap;
+                }
+            }
+        }
+        return report;
+    }
+
+}// namespace wrench
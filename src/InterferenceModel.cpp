@@ -0,0 +1,76 @@
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "InterferenceModel.h"
+
+namespace wrench {
+
+    /**
+     * @brief Constructor
+     *
+     * @param task_graph_store: the task metadata of the workflow
+     * @param max_slowdown: the slowdown of a memory-bound task on a node full of memory-bound tasks (>= 1)
+     * @param reference_bytes_per_flop: the bytes per flop of a memory-bound task (intensity 1), e.g. the
+     *        memory bandwidth of a node divided by its flop rate (> 0)
+     * @param category_intensities: memory intensities that override the ones derived from the bytes per
+     *        flop of the task categories, by category name
+     *
+     * @throw std::invalid_argument
+     */
+    InterferenceModel::InterferenceModel(const TaskGraphStore &task_graph_store, double max_slowdown,
+                                         double reference_bytes_per_flop, const std::map<std::string, double> &category_intensities)
+        : max_slowdown(max_slowdown), intensities(task_graph_store.getNumCategories(), 0.0) {
+        if (max_slowdown < 1.0) {
+            throw std::invalid_argument("InterferenceModel::InterferenceModel(): The maximum slowdown must be at least 1");
+        }
+        if (reference_bytes_per_flop <= 0.0) {
+            throw std::invalid_argument("InterferenceModel::InterferenceModel(): The reference bytes per flop must be positive");
+        }
+
+        // Bytes per flop of each category, relative to the reference, so that the intensity of a category
+        // does not depend on the other categories of the workflow
+        std::vector<double> bytes(this->intensities.size(), 0.0);
+        std::vector<double> flops(this->intensities.size(), 0.0);
+        for (unsigned long i = 0; i < task_graph_store.getNumTasks(); i++) {
+            auto category = task_graph_store.task_categories[i];
+            bytes[category] += task_graph_store.task_input_bytes[i] + task_graph_store.task_output_bytes[i];
+            flops[category] += task_graph_store.task_flops[i];
+        }
+        for (unsigned long category = 0; category < this->intensities.size(); category++) {
+            this->intensities[category] = flops[category] > 0.0
+                                                  ? std::min(1.0, bytes[category] / flops[category] / reference_bytes_per_flop)
+                                                  : 0.0;
+        }
+
+        for (auto const &intensity: category_intensities) {
+            if (intensity.second < 0.0 or intensity.second > 1.0) {
+                throw std::invalid_argument("InterferenceModel::InterferenceModel(): The memory intensity of " +
+                                            intensity.first + " must be in [0, 1]");
+            }
+            auto category = task_graph_store.getCategoryIndex(intensity.first);
+            if (category < 0) {
+                throw std::invalid_argument("InterferenceModel::InterferenceModel(): No task of the workflow has category " +
+                                            intensity.first);
+            }
+            this->intensities[category] = intensity.second;
+        }
+    }
+
+    /**
+     * @brief Get the slowdown of a task that starts on a node
+     *
+     * @param category: the category of the task
+     * @param co_runner_intensity: the sum of the memory intensities of the tasks running on the node
+     * @param num_cores: the number of cores of the node
+     * @return a factor (>= 1) by which the compute time of the task is multiplied
+     */
+    double InterferenceModel::getSlowdown(unsigned int category, double co_runner_intensity, unsigned long num_cores) const {
+        if (num_cores <= 1) {
+            return 1.0;
+        }
+        double pressure = std::min(1.0, co_runner_intensity / (double) (num_cores - 1));
+        return 1.0 + (this->max_slowdown - 1.0) * this->intensities[category] * pressure;
+    }
+
+}// namespace wrench
@@ -0,0 +1,132 @@
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "PolicyChannel.h"
+
+namespace wrench {
+
+    /**
+     * @brief Constructor
+     *
+     * @param read_fd: the file descriptor actions are read from
+     * @param write_fd: the file descriptor observations are written to
+     */
+    PolicyChannel::PolicyChannel(int read_fd, int write_fd) : read_fd(read_fd), write_fd(write_fd) {
+    }
+
+    PolicyChannel::~PolicyChannel() {
+        close(this->read_fd);
+        close(this->write_fd);
+    }
+
+    /**
+     * @brief Parse the file descriptors of a channel
+     *
+     * @param fds: "<read fd>,<write fd>"
+     * @return the read and write file descriptors
+     *
+     * @throw std::invalid_argument
+     */
+    std::pair<int, int> PolicyChannel::parseFileDescriptors(const std::string &fds) {
+        auto separator = fds.find(',');
+        try {
+            if (separator != std::string::npos) {
+                return {std::stoi(fds.substr(0, separator)), std::stoi(fds.substr(separator + 1))};
+            }
+        } catch (std::exception &) {
+        }
+        throw std::invalid_argument("PolicyChannel::parseFileDescriptors(): Invalid file descriptors " + fds +
+                                    " (expected <read fd>,<write fd>)");
+    }
+
+    /**
+     * @brief Send an observation, and wait for the action
+     *
+     * @param observation: an observation
+     * @return the compute service slot of each ready task (-1 to defer it)
+     *
+     * @throw std::runtime_error
+     */
+    std::vector<int32_t> PolicyChannel::decide(const PolicyObservation &observation) {
+        send(0, observation);
+
+        auto read_exactly = [this](void *data, size_t size) {
+            auto bytes = static_cast<char *>(data);
+            while (size > 0) {
+                ssize_t count = read(this->read_fd, bytes, size);
+                if (count < 0 and errno == EINTR) {
+                    continue;
+                }
+                if (count <= 0) {
+                    throw std::runtime_error(std::string("PolicyChannel::decide(): Cannot read the action: ") +
+                                             (count == 0 ? "end of file" : strerror(errno)));
+                }
+                bytes += count;
+                size -= count;
+            }
+        };
+        uint32_t num_actions;
+        read_exactly(&num_actions, sizeof(num_actions));
+        if (num_actions != observation.task_indices.size()) {
+            throw std::runtime_error("PolicyChannel::decide(): Expected " + std::to_string(observation.task_indices.size()) +
+                                     " actions, got " + std::to_string(num_actions));
+        }
+        std::vector<int32_t> actions(num_actions);
+        read_exactly(actions.data(), num_actions * sizeof(int32_t));
+        return actions;
+    }
+
+    /**
+     * @brief Send the final observation of the episode (no action is expected)
+     *
+     * @param observation: an observation, with no ready task
+     */
+    void PolicyChannel::endEpisode(const PolicyObservation &observation) {
+        send(1, observation);
+    }
+
+    /**
+     * @brief Serialize and write an observation message in a single write
+     *
+     * @param type: the message type
+     * @param observation: an observation
+     *
+     * @throw std::runtime_error
+     */
+    void PolicyChannel::send(uint32_t type, const PolicyObservation &observation) {
+        this->buffer.clear();
+        auto append = [this](const void *data, size_t size) { this->buffer.append(static_cast<const char *>(data), size); };
+        uint32_t header[4] = {type, (uint32_t) observation.task_indices.size(), (uint32_t) observation.service_total_cores.size(),
+                              (uint32_t) observation.host_pstates.size()};
+        append(header, sizeof(header));
+        append(&observation.date, sizeof(double));
+        append(&observation.energy, sizeof(double));
+        for (auto array: {&observation.task_predicted_runtimes, &observation.task_flops, &observation.task_io_bytes,
+                          &observation.task_categories, &observation.task_num_children,
+                          &observation.service_idle_cores, &observation.service_total_cores, &observation.service_speeds,
+                          &observation.service_idle_watts, &observation.service_all_cores_watts,
+                          &observation.service_accelerators,
+                          &observation.host_pstates, &observation.host_powered_down}) {
+            append(array->data(), array->size() * sizeof(double));
+        }
+        append(observation.task_indices.data(), observation.task_indices.size() * sizeof(uint32_t));
+
+        const char *bytes = this->buffer.data();
+        size_t size = this->buffer.size();
+        while (size > 0) {
+            ssize_t count = write(this->write_fd, bytes, size);
+            if (count < 0 and errno == EINTR) {
+                continue;
+            }
+            if (count < 0) {
+                throw std::runtime_error(std::string("PolicyChannel::send(): Cannot write the observation: ") + strerror(errno));
+            }
+            bytes += count;
+            size -= count;
+        }
+    }
+
+}// namespace wrench
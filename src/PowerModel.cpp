@@ -0,0 +1,282 @@
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+#include <simgrid/s4u.hpp>
+
+#include "PowerModel.h"
+
+namespace wrench {
+
+    /**
+     * @brief Get the power drawn by the host with a given (possibly fractional) number of busy cores,
+     *        following SimGrid's linear host energy model, in which the CPU load is the fraction of
+     *        the host computing capacity in use, or the socket-aware model on multi-socket hosts
+     *
+     * @param busy_cores: the number of busy cores (e.g., 0.5 for a single core used at 50%)
+     * @param consolidated: whether the busy cores are consolidated onto as few sockets as possible
+     *        (rather than spread evenly over the sockets)
+     * @return a power in Watts
+     */
+    double HostPowerProfile::getPower(double busy_cores, bool consolidated) const {
+        if (not this->isSocketAware()) {
+            if (busy_cores <= 0.0) {
+                return this->idle_watts;
+            }
+            busy_cores = std::min(busy_cores, (double) this->num_cores);
+            if (this->num_cores == 1) {
+                return this->all_cores_watts;
+            }
+            return this->one_core_watts + (this->all_cores_watts - this->one_core_watts) *
+                                                  (busy_cores - 1.0) / (double) (this->num_cores - 1);
+        }
+
+        busy_cores = std::max(0.0, std::min(busy_cores, (double) this->num_cores));
+        double sockets = (double) this->num_sockets;
+        double socket_cores = (double) this->num_cores / sockets;
+        double socket_idle_watts = this->idle_watts / sockets;
+        double socket_all_cores_watts = this->all_cores_watts / sockets;
+        // A gated socket cannot draw more than its share of the idle power (e.g., in the sleep pstate)
+        double socket_gated_watts = this->gated_socket_watts >= 0.0 ? std::min(this->gated_socket_watts, socket_idle_watts)
+                                                                     : socket_idle_watts;
+        double activation_watts = this->one_core_watts - this->idle_watts;
+        double spread_cores = std::floor(busy_cores / sockets);
+        double power = 0.0;
+        for (unsigned long socket = 0; socket < this->num_sockets; socket++) {
+            double socket_busy_cores = consolidated ? std::min(socket_cores, std::max(0.0, busy_cores - (double) socket * socket_cores))
+                                                    : spread_cores + std::min(1.0, std::max(0.0, busy_cores - spread_cores * sockets - (double) socket));
+            if (socket_busy_cores <= 0.0) {
+                power += socket_gated_watts;
+            } else if (socket_cores <= 1.0) {
+                power += socket_all_cores_watts;
+            } else {
+                power += socket_idle_watts + activation_watts +
+                         (socket_all_cores_watts - socket_idle_watts - activation_watts) * (socket_busy_cores - 1.0) / (socket_cores - 1.0);
+            }
+        }
+        return power;
+    }
+
+    /**
+     * @brief Get the additional power drawn by the host when more cores become busy
+     *
+     * @param busy_cores: the number of cores already busy
+     * @param additional_cores: the number of cores that become busy
+     * @param consolidated: whether the busy cores are consolidated onto as few sockets as possible
+     * @return a power in Watts
+     */
+    double HostPowerProfile::getMarginalPower(double busy_cores, double additional_cores, bool consolidated) const {
+        return this->getPower(busy_cores + additional_cores, consolidated) - this->getPower(busy_cores, consolidated);
+    }
+
+    /**
+     * @brief Get the energy the host spends per flop computed with a given number of busy cores,
+     *        idle power included (the lower, the more energy-proportional the pstate at that load)
+     *
+     * @param busy_cores: the number of busy cores (> 0)
+     * @param consolidated: whether the busy cores are consolidated onto as few sockets as possible
+     * @return an energy in Joules per flop
+     */
+    double HostPowerProfile::getEnergyPerFlop(double busy_cores, bool consolidated) const {
+        busy_cores = std::min(busy_cores, (double) this->num_cores);
+        return this->getPower(busy_cores, consolidated) / (busy_cores * this->speed);
+    }
+
+    /**
+     * @brief Build the power profile of a host of the simulated platform, in its current pstate
+     *
+     * @param hostname: the name of the host
+     * @return a power profile
+     *
+     * @throw std::invalid_argument
+     */
+    HostPowerProfile HostPowerProfile::fromHost(const std::string &hostname) {
+        auto host = simgrid::s4u::Host::by_name_or_null(hostname);
+        if (host == nullptr) {
+            throw std::invalid_argument("HostPowerProfile::fromHost(): Unknown host " + hostname);
+        }
+        return fromHost(hostname, host->get_pstate());
+    }
+
+    /**
+     * @brief Build the power profile of a host of the simulated platform in a given pstate
+     *
+     * @param hostname: the name of the host
+     * @param pstate: a pstate of the host
+     * @return a power profile
+     *
+     * @throw std::invalid_argument
+     */
+    HostPowerProfile HostPowerProfile::fromHost(const std::string &hostname, unsigned long pstate) {
+        auto host = simgrid::s4u::Host::by_name_or_null(hostname);
+        if (host == nullptr) {
+            throw std::invalid_argument("HostPowerProfile::fromHost(): Unknown host " + hostname);
+        }
+        if (pstate >= host->get_pstate_count()) {
+            throw std::invalid_argument("HostPowerProfile::fromHost(): Invalid pstate " + std::to_string(pstate) +
+                                        " for host " + hostname);
+        }
+        HostPowerProfile profile;
+        profile.pstate = pstate;
+        profile.num_cores = host->get_core_count();
+        profile.speed = host->get_pstate_speed(pstate);
+
+        const char *wattage = host->get_property("wattage_per_state");
+        if (wattage == nullptr) {
+            return profile;
+        }
+        // One "idle:one-core:all-cores" entry per pstate, comma-separated
+        std::istringstream pstates(wattage);
+        std::string entry;
+        for (unsigned long i = 0; i <= pstate; i++) {
+            if (not std::getline(pstates, entry, ',')) {
+                throw std::invalid_argument("HostPowerProfile::fromHost(): No wattage for pstate " + std::to_string(pstate) +
+                                            " of host " + hostname);
+            }
+        }
+        std::replace(entry.begin(), entry.end(), ':', ' ');
+        std::istringstream values(entry);
+        if (not(values >> profile.idle_watts >> profile.one_core_watts >> profile.all_cores_watts)) {
+            throw std::invalid_argument("HostPowerProfile::fromHost(): Invalid wattage_per_state for host " + hostname);
+        }
+
+        const char *sockets = host->get_property("sockets");
+        if (sockets != nullptr) {
+            long num_sockets = std::stol(sockets);
+            if (num_sockets < 1 or (unsigned long) num_sockets > profile.num_cores) {
+                throw std::invalid_argument("HostPowerProfile::fromHost(): Invalid sockets for host " + hostname);
+            }
+            profile.num_sockets = num_sockets;
+        }
+        const char *gated_wattage = host->get_property("socket_gated_wattage");
+        if (gated_wattage != nullptr) {
+            profile.gated_socket_watts = std::stod(gated_wattage);
+        }
+        return profile;
+    }
+
+    /**
+     * @brief Build the power profiles of a host of the simulated platform in all its pstates
+     *
+     * @param hostname: the name of the host
+     * @return the power profiles, by pstate
+     *
+     * @throw std::invalid_argument
+     */
+    std::vector<HostPowerProfile> HostPowerProfile::getPstateProfiles(const std::string &hostname) {
+        auto host = simgrid::s4u::Host::by_name_or_null(hostname);
+        if (host == nullptr) {
+            throw std::invalid_argument("HostPowerProfile::getPstateProfiles(): Unknown host " + hostname);
+        }
+        std::vector<HostPowerProfile> profiles;
+        for (unsigned long pstate = 0; pstate < host->get_pstate_count(); pstate++) {
+            profiles.push_back(fromHost(hostname, pstate));
+        }
+        return profiles;
+    }
+
+    /**
+     * @brief Get the pstate that models a powered-down host (its "sleep_pstate" property)
+     *
+     * @param hostname: the name of the host
+     * @return a pstate, or -1 if the host cannot be powered down
+     *
+     * @throw std::invalid_argument
+     */
+    long HostPowerProfile::getSleepPstate(const std::string &hostname) {
+        auto host = simgrid::s4u::Host::by_name_or_null(hostname);
+        if (host == nullptr) {
+            throw std::invalid_argument("HostPowerProfile::getSleepPstate(): Unknown host " + hostname);
+        }
+        const char *sleep_pstate = host->get_property("sleep_pstate");
+        if (sleep_pstate == nullptr) {
+            return -1;
+        }
+        long pstate = std::stol(sleep_pstate);
+        if (pstate < 0 or pstate >= (long) host->get_pstate_count()) {
+            throw std::invalid_argument("HostPowerProfile::getSleepPstate(): Invalid sleep_pstate for host " + hostname);
+        }
+        return pstate;
+    }
+
+    /**
+     * @brief Get the time a powered-down host takes to become usable (its "boot_time" property)
+     *
+     * @param hostname: the name of the host
+     * @return a time in seconds (0 if unspecified)
+     *
+     * @throw std::invalid_argument
+     */
+    double HostPowerProfile::getBootTime(const std::string &hostname) {
+        auto host = simgrid::s4u::Host::by_name_or_null(hostname);
+        if (host == nullptr) {
+            throw std::invalid_argument("HostPowerProfile::getBootTime(): Unknown host " + hostname);
+        }
+        const char *boot_time = host->get_property("boot_time");
+        return (boot_time == nullptr) ? 0.0 : std::stod(boot_time);
+    }
+
+    /**
+     * @brief Get the turbo pstate of a host (its "turbo_pstate" property), i.e., a pstate faster than the
+     *        nominal ones that is only available while few cores are busy
+     *
+     * @param hostname: the name of the host
+     * @return a pstate, or -1 if the host has no turbo pstate
+     *
+     * @throw std::invalid_argument
+     */
+    long HostPowerProfile::getTurboPstate(const std::string &hostname) {
+        auto host = simgrid::s4u::Host::by_name_or_null(hostname);
+        if (host == nullptr) {
+            throw std::invalid_argument("HostPowerProfile::getTurboPstate(): Unknown host " + hostname);
+        }
+        const char *turbo_pstate = host->get_property("turbo_pstate");
+        if (turbo_pstate == nullptr) {
+            return -1;
+        }
+        long pstate = std::stol(turbo_pstate);
+        if (pstate < 0 or pstate >= (long) host->get_pstate_count()) {
+            throw std::invalid_argument("HostPowerProfile::getTurboPstate(): Invalid turbo_pstate for host " + hostname);
+        }
+        return pstate;
+    }
+
+    /**
+     * @brief Get the maximum number of busy cores at which a host can run in its turbo pstate (its
+     *        "turbo_max_cores" property)
+     *
+     * @param hostname: the name of the host
+     * @return a number of cores (all the cores of the host if unspecified)
+     *
+     * @throw std::invalid_argument
+     */
+    unsigned long HostPowerProfile::getTurboMaxCores(const std::string &hostname) {
+        auto host = simgrid::s4u::Host::by_name_or_null(hostname);
+        if (host == nullptr) {
+            throw std::invalid_argument("HostPowerProfile::getTurboMaxCores(): Unknown host " + hostname);
+        }
+        const char *turbo_max_cores = host->get_property("turbo_max_cores");
+        return (turbo_max_cores == nullptr) ? host->get_core_count() : std::stoul(turbo_max_cores);
+    }
+
+    /**
+     * @brief Get the time a socket of a host takes to leave its deep idle state (package C-state) when a
+     *        task starts on it (its "cstate_wakeup_latency" property)
+     *
+     * @param hostname: the name of the host
+     * @return a time in seconds (0 if unspecified)
+     *
+     * @throw std::invalid_argument
+     */
+    double HostPowerProfile::getWakeUpLatency(const std::string &hostname) {
+        auto host = simgrid::s4u::Host::by_name_or_null(hostname);
+        if (host == nullptr) {
+            throw std::invalid_argument("HostPowerProfile::getWakeUpLatency(): Unknown host " + hostname);
+        }
+        const char *wakeup_latency = host->get_property("cstate_wakeup_latency");
+        return (wakeup_latency == nullptr) ? 0.0 : std::stod(wakeup_latency);
+    }
+
+}// namespace wrench
@@ -0,0 +1,254 @@
+#include <algorithm>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "RecipeRepository.h"
+
+namespace wrench {
+
+    namespace {
+
+        const char repository_magic[8] = {'W', 'F', 'P', 'A', 'C', 'K', '0', '2'};
+
+        /** @brief The file header */
+        struct RepositoryHeader {
+            char magic[8];
+            uint64_t num_entries;
+            uint64_t index_offset;
+            uint64_t names_offset;
+        };
+
+        /** @brief An index entry, as stored in the file */
+        struct RepositoryIndexEntry {
+            uint64_t offset;
+            uint64_t length;
+            uint32_t num_tasks;
+            uint32_t seed;
+            uint32_t name_offset;
+            uint32_t name_length;
+        };
+
+        /** @brief The header of a recipe block, followed by its arrays */
+        struct RecipeHeader {
+            uint32_t num_tasks;
+            uint32_t num_files;
+            uint32_t num_inputs;
+            uint32_t num_outputs;
+            uint32_t num_dependencies;
+            uint32_t strings_length;
+        };
+
+        static_assert(sizeof(RepositoryHeader) == 32 and sizeof(RepositoryIndexEntry) == 32 and sizeof(RecipeHeader) == 24,
+                      "Unexpected padding in the recipe repository structures");
+
+        /** @brief Whether [offset, offset + length) lies within [0, size), without overflowing */
+        bool fits(uint64_t offset, uint64_t length, uint64_t size) {
+            return offset <= size and length <= size - offset;
+        }
+
+        /** @brief Whether CSR offsets (count + 1 of them) are non-decreasing and end within limit */
+        bool validOffsets(const uint32_t *offsets, size_t count, size_t limit) {
+            for (size_t i = 0; i < count; i++) {
+                if (offsets[i] > offsets[i + 1]) {
+                    return false;
+                }
+            }
+            return offsets[count] <= limit;
+        }
+
+        /** @brief Whether all indices are below limit */
+        bool validIndices(const uint32_t *indices, size_t count, size_t limit) {
+            for (size_t i = 0; i < count; i++) {
+                if (indices[i] >= limit) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    }// namespace
+
+    /**
+     * @brief Constructor, which maps the repository file and reads its index
+     *
+     * @param path: the path of the repository file
+     *
+     * @throw std::runtime_error
+     * @throw std::invalid_argument
+     */
+    RecipeRepository::RecipeRepository(const std::string &path) : path(path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("RecipeRepository::RecipeRepository(): Cannot open " + path + ": " + strerror(errno));
+        }
+        struct stat status {};
+        if (fstat(fd, &status) != 0 or status.st_size < (off_t) sizeof(RepositoryHeader)) {
+            close(fd);
+            throw std::invalid_argument("RecipeRepository::RecipeRepository(): " + path + " is not a recipe repository (or was packed by an older src/wfpackrecipes.py)");
+        }
+        this->size = status.st_size;
+        void *mapping = mmap(nullptr, this->size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("RecipeRepository::RecipeRepository(): Cannot map " + path + ": " + strerror(errno));
+        }
+        this->data = static_cast<const char *>(mapping);
+        // Simulations touch only the recipe they run
+        madvise(mapping, this->size, MADV_RANDOM);
+
+        auto header = reinterpret_cast<const RepositoryHeader *>(this->data);
+        if (memcmp(header->magic, repository_magic, sizeof(repository_magic)) != 0 or header->index_offset > this->size or
+            header->num_entries > (this->size - header->index_offset) / sizeof(RepositoryIndexEntry) or
+            header->names_offset > this->size) {
+            munmap(mapping, this->size);
+            throw std::invalid_argument("RecipeRepository::RecipeRepository(): " + path + " is not a recipe repository (or was packed by an older src/wfpackrecipes.py)");
+        }
+        auto index = reinterpret_cast<const RepositoryIndexEntry *>(this->data + header->index_offset);
+        this->entries.reserve(header->num_entries);
+        for (uint64_t i = 0; i < header->num_entries; i++) {
+            if (not fits(index[i].offset, index[i].length, this->size) or index[i].length < sizeof(RecipeHeader) or
+                not fits(header->names_offset + index[i].name_offset, index[i].name_length, this->size)) {
+                munmap(mapping, this->size);
+                throw std::invalid_argument("RecipeRepository::RecipeRepository(): Corrupted index in " + path);
+            }
+            this->entries.push_back({std::string(this->data + header->names_offset + index[i].name_offset, index[i].name_length),
+                                     index[i].num_tasks, index[i].seed, index[i].offset, index[i].length});
+            this->entry_indices[getKey(this->entries.back())] = i;
+        }
+    }
+
+    RecipeRepository::~RecipeRepository() {
+        if (this->data) {
+            munmap(const_cast<char *>(this->data), this->size);
+        }
+    }
+
+    /**
+     * @brief Get the key of an index entry
+     *
+     * @param entry: an entry
+     * @return a key <family>/<number of tasks>/<seed>
+     */
+    std::string RecipeRepository::getKey(const Entry &entry) {
+        return entry.family + "/" + std::to_string(entry.num_tasks) + "/" + std::to_string(entry.seed);
+    }
+
+    /**
+     * @brief Determine whether the repository contains a recipe
+     *
+     * @param key: a key <family>/<number of tasks>/<seed>
+     * @return true or false
+     */
+    bool RecipeRepository::hasRecipe(const std::string &key) const {
+        return this->entry_indices.find(key) != this->entry_indices.end();
+    }
+
+    /**
+     * @brief Create a workflow from a packed recipe, with the same conventions as WfFormatLoader
+     *        (task flops are runtimes times the reference flop rate, tasks use their packed core count)
+     *
+     * @param key: a key <family>/<number of tasks>/<seed>
+     * @param reference_flop_rate: the flop rate at which task runtimes were measured (e.g., "100Gf")
+     * @return a workflow
+     *
+     * @throw std::invalid_argument
+     */
+    std::shared_ptr<Workflow> RecipeRepository::createWorkflow(const std::string &key, const std::string &reference_flop_rate) const {
+        auto entry_index = this->entry_indices.find(key);
+        if (entry_index == this->entry_indices.end()) {
+            throw std::invalid_argument("RecipeRepository::createWorkflow(): No recipe " + key + " in " + this->path);
+        }
+        auto const &entry = this->entries[entry_index->second];
+        double flop_rate = UnitParser::parse_compute_speed(reference_flop_rate);
+
+        // The recipe block is a sequence of arrays, laid out as in src/wfpackrecipes.py
+        const char *block = this->data + entry.offset;
+        madvise(const_cast<char *>(block) - ((uintptr_t) block % getpagesize()),
+                entry.length + ((uintptr_t) block % getpagesize()), MADV_WILLNEED);
+        auto header = reinterpret_cast<const RecipeHeader *>(block);
+        const size_t num_tasks = header->num_tasks;
+        const size_t num_files = header->num_files;
+        // Each array must lie within the recipe block (the counts come from the file and are not trusted)
+        size_t position = (sizeof(RecipeHeader) + 7) & ~(size_t) 7;
+        bool truncated = false;
+        auto next = [&](size_t count, size_t item_size) {
+            if (truncated or position > entry.length or count > (entry.length - position) / item_size) {
+                truncated = true;
+                return block;
+            }
+            auto array = block + position;
+            position += count * item_size;
+            return array;
+        };
+        auto runtimes = reinterpret_cast<const double *>(next(num_tasks, sizeof(double)));
+        auto avg_cpus = reinterpret_cast<const double *>(next(num_tasks, sizeof(double)));
+        auto read_bytes = reinterpret_cast<const double *>(next(num_tasks, sizeof(double)));
+        auto written_bytes = reinterpret_cast<const double *>(next(num_tasks, sizeof(double)));
+        auto memories = reinterpret_cast<const double *>(next(num_tasks, sizeof(double)));
+        auto file_sizes = reinterpret_cast<const uint64_t *>(next(num_files, sizeof(uint64_t)));
+        auto core_counts = reinterpret_cast<const uint32_t *>(next(num_tasks, sizeof(uint32_t)));
+        auto task_id_offsets = reinterpret_cast<const uint32_t *>(next(num_tasks + 1, sizeof(uint32_t)));
+        auto file_id_offsets = reinterpret_cast<const uint32_t *>(next(num_files + 1, sizeof(uint32_t)));
+        auto input_offsets = reinterpret_cast<const uint32_t *>(next(num_tasks + 1, sizeof(uint32_t)));
+        auto inputs = reinterpret_cast<const uint32_t *>(next(header->num_inputs, sizeof(uint32_t)));
+        auto output_offsets = reinterpret_cast<const uint32_t *>(next(num_tasks + 1, sizeof(uint32_t)));
+        auto outputs = reinterpret_cast<const uint32_t *>(next(header->num_outputs, sizeof(uint32_t)));
+        auto parents = reinterpret_cast<const uint32_t *>(next(header->num_dependencies, sizeof(uint32_t)));
+        auto children = reinterpret_cast<const uint32_t *>(next(header->num_dependencies, sizeof(uint32_t)));
+        auto strings = next(header->strings_length, 1);
+        // The offsets and indices stored in the arrays must stay within the arrays they point into
+        if (truncated or
+            not validOffsets(task_id_offsets, num_tasks, header->strings_length) or
+            not validOffsets(file_id_offsets, num_files, header->strings_length) or
+            not validOffsets(input_offsets, num_tasks, header->num_inputs) or
+            not validOffsets(output_offsets, num_tasks, header->num_outputs) or
+            not validIndices(inputs, header->num_inputs, num_files) or
+            not validIndices(outputs, header->num_outputs, num_files) or
+            not validIndices(parents, header->num_dependencies, num_tasks) or
+            not validIndices(children, header->num_dependencies, num_tasks)) {
+            throw std::invalid_argument("RecipeRepository::createWorkflow(): Corrupted recipe " + key + " in " + this->path);
+        }
+
+        auto workflow = Workflow::createWorkflow();
+        std::vector<std::shared_ptr<DataFile>> files(num_files);
+        for (size_t i = 0; i < num_files; i++) {
+            files[i] = workflow->addFile(std::string(strings + file_id_offsets[i], file_id_offsets[i + 1] - file_id_offsets[i]),
+                                         file_sizes[i]);
+        }
+        std::vector<std::shared_ptr<WorkflowTask>> tasks(num_tasks);
+        for (size_t i = 0; i < num_tasks; i++) {
+            auto task = workflow->addTask(std::string(strings + task_id_offsets[i], task_id_offsets[i + 1] - task_id_offsets[i]),
+                                          runtimes[i] * flop_rate, std::max<uint32_t>(core_counts[i], 1),
+                                          std::max<uint32_t>(core_counts[i], 1), (sg_size_t) memories[i]);
+            if (avg_cpus[i] >= 0.0) {
+                task->setAverageCPU(avg_cpus[i]);
+            }
+            if (read_bytes[i] >= 0.0) {
+                task->setBytesRead((unsigned long) read_bytes[i]);
+            }
+            if (written_bytes[i] >= 0.0) {
+                task->setBytesWritten((unsigned long) written_bytes[i]);
+            }
+            for (auto j = input_offsets[i]; j < input_offsets[i + 1]; j++) {
+                task->addInputFile(files[inputs[j]]);
+            }
+            for (auto j = output_offsets[i]; j < output_offsets[i + 1]; j++) {
+                task->addOutputFile(files[outputs[j]]);
+            }
+            tasks[i] = task;
+        }
+        for (size_t i = 0; i < header->num_dependencies; i++) {
+            workflow->addControlDependency(tasks[parents[i]], tasks[children[i]]);
+        }
+
+        return workflow;
+    }
+
+}// namespace wrench
@@ -0,0 +1,236 @@
+
+#include <ctime>
+#include <stdexcept>
+
+#ifdef ENABLE_SQLITE3
+#include <sqlite3.h>
+#endif
+
+#include "ResultsDatabase.h"
+
+namespace wrench {
+
+    /**
+     * @brief Whether the simulator was built with SQLite, i.e., whether a database can be opened
+     *
+     * @return true or false
+     */
+    bool ResultsDatabase::isAvailable() {
+#ifdef ENABLE_SQLITE3
+        return true;
+#else
+        return false;
+#endif
+    }
+
+#ifndef ENABLE_SQLITE3
+
+    /**
+     * @brief Constructor (unavailable: built without SQLite)
+     *
+     * @param path: the path of the database file
+     *
+     * @throw std::runtime_error
+     */
+    ResultsDatabase::ResultsDatabase(const std::string &path) : path(path) {
+        throw std::runtime_error("ResultsDatabase::ResultsDatabase(): Cannot open " + path +
+                                 ": the simulator was built without SQLite");
+    }
+
+    ResultsDatabase::~ResultsDatabase() = default;
+
+    /**
+     * @brief Insert the results of a run (unavailable: built without SQLite)
+     *
+     * @throw std::runtime_error
+     */
+    long ResultsDatabase::insertRun(const ResultsRun &run,
+                                    const std::map<std::string, std::string> &parameters,
+                                    const std::vector<ResultsHost> &hosts,
+                                    const std::vector<ResultsTask> &tasks,
+                                    const std::map<std::string, double> &metrics) {
+        throw std::runtime_error("ResultsDatabase::insertRun(): The simulator was built without SQLite");
+    }
+
+#else
+
+    /**
+     * @brief The tables and indexes of the database (src/results_db.py creates the same ones)
+     */
+    static const char *schema =
+            "CREATE TABLE IF NOT EXISTS runs (run_key INTEGER PRIMARY KEY, run_id TEXT, created REAL, platform TEXT, "
+            "workflow TEXT, num_tasks INTEGER, tasks_failed INTEGER, makespan REAL, energy REAL);"
+            "CREATE TABLE IF NOT EXISTS parameters (run_key INTEGER REFERENCES runs (run_key), name TEXT, value TEXT);"
+            "CREATE TABLE IF NOT EXISTS hosts (run_key INTEGER REFERENCES runs (run_key), host_name TEXT, num_cores INTEGER, "
+            "energy REAL, power REAL);"
+            "CREATE TABLE IF NOT EXISTS tasks (run_key INTEGER REFERENCES runs (run_key), task_id TEXT, host_name TEXT, "
+            "num_cores INTEGER, start_date REAL, end_date REAL, compute_time REAL, io_input_time REAL, io_output_time REAL, "
+            "failures INTEGER);"
+            "CREATE TABLE IF NOT EXISTS metrics (run_key INTEGER REFERENCES runs (run_key), name TEXT, value REAL);"
+            "CREATE INDEX IF NOT EXISTS runs_workflow ON runs (workflow);"
+            "CREATE INDEX IF NOT EXISTS runs_num_tasks ON runs (num_tasks);"
+            "CREATE INDEX IF NOT EXISTS parameters_name_value ON parameters (name, value, run_key);"
+            "CREATE INDEX IF NOT EXISTS parameters_run ON parameters (run_key);"
+            "CREATE INDEX IF NOT EXISTS hosts_run ON hosts (run_key);"
+            "CREATE INDEX IF NOT EXISTS hosts_name ON hosts (host_name, run_key);"
+            "CREATE INDEX IF NOT EXISTS tasks_run ON tasks (run_key);"
+            "CREATE INDEX IF NOT EXISTS metrics_name ON metrics (name, run_key);"
+            "CREATE INDEX IF NOT EXISTS metrics_run ON metrics (run_key);";
+
+    /**
+     * @brief Execute SQL statements that return no rows
+     *
+     * @param connection: a SQLite connection
+     * @param sql: the statements
+     *
+     * @throw std::runtime_error
+     */
+    static void execute(sqlite3 *connection, const std::string &sql) {
+        char *error = nullptr;
+        if (sqlite3_exec(connection, sql.c_str(), nullptr, nullptr, &error) != SQLITE_OK) {
+            std::string message = error ? error : "unknown error";
+            sqlite3_free(error);
+            throw std::runtime_error("ResultsDatabase: " + message);
+        }
+    }
+
+    /**
+     *  @brief A prepared statement, bound and run once per row
+     */
+    class PreparedStatement {
+
+    public:
+        PreparedStatement(sqlite3 *connection, const char *sql) : connection(connection) {
+            if (sqlite3_prepare_v2(connection, sql, -1, &this->statement, nullptr) != SQLITE_OK) {
+                throw std::runtime_error(std::string("ResultsDatabase: ") + sqlite3_errmsg(connection));
+            }
+        }
+
+        ~PreparedStatement() {
+            sqlite3_finalize(this->statement);
+        }
+
+        PreparedStatement &bind(int index, const std::string &value) {
+            sqlite3_bind_text(this->statement, index, value.c_str(), (int) value.size(), SQLITE_TRANSIENT);
+            return *this;
+        }
+
+        PreparedStatement &bind(int index, double value) {
+            sqlite3_bind_double(this->statement, index, value);
+            return *this;
+        }
+
+        PreparedStatement &bind(int index, long value) {
+            sqlite3_bind_int64(this->statement, index, value);
+            return *this;
+        }
+
+        void run() {
+            if (sqlite3_step(this->statement) != SQLITE_DONE) {
+                throw std::runtime_error(std::string("ResultsDatabase: ") + sqlite3_errmsg(this->connection));
+            }
+            sqlite3_reset(this->statement);
+        }
+
+    private:
+        sqlite3 *connection;
+        sqlite3_stmt *statement = nullptr;
+    };
+
+    /**
+     * @brief Constructor, which opens (or creates) a database
+     *
+     * @param path: the path of the database file
+     *
+     * @throw std::runtime_error
+     */
+    ResultsDatabase::ResultsDatabase(const std::string &path) : path(path) {
+        sqlite3 *connection = nullptr;
+        if (sqlite3_open(path.c_str(), &connection) != SQLITE_OK) {
+            std::string message = connection ? sqlite3_errmsg(connection) : "out of memory";
+            sqlite3_close(connection);
+            throw std::runtime_error("ResultsDatabase::ResultsDatabase(): Cannot open " + path + ": " + message);
+        }
+        this->connection = connection;
+        // Concurrent runs wait for each other's transactions rather than failing
+        sqlite3_busy_timeout(connection, 60000);
+        execute(connection, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;");
+        execute(connection, schema);
+    }
+
+    ResultsDatabase::~ResultsDatabase() {
+        sqlite3_close(static_cast<sqlite3 *>(this->connection));
+    }
+
+    /**
+     * @brief Insert the results of a run, in one transaction
+     *
+     * @param run: the summary of the run
+     * @param parameters: the simulator options of the run, by name
+     * @param hosts: the results of each host
+     * @param tasks: the executions of the tasks
+     * @param metrics: the metrics of the run (those of execution_metrics.csv)
+     * @return the key of the run in the database
+     *
+     * @throw std::runtime_error
+     */
+    long ResultsDatabase::insertRun(const ResultsRun &run,
+                                    const std::map<std::string, std::string> &parameters,
+                                    const std::vector<ResultsHost> &hosts,
+                                    const std::vector<ResultsTask> &tasks,
+                                    const std::map<std::string, double> &metrics) {
+        auto connection = static_cast<sqlite3 *>(this->connection);
+        // The write lock is taken upfront, so that concurrent runs queue instead of deadlocking
+        execute(connection, "BEGIN IMMEDIATE");
+        long run_key;
+        try {
+            PreparedStatement(connection, "INSERT INTO runs (run_id, created, platform, workflow, num_tasks, tasks_failed, "
+                                          "makespan, energy) VALUES (?, ?, ?, ?, ?, ?, ?, ?)")
+                    .bind(1, run.run_id)
+                    .bind(2, (double) std::time(nullptr))
+                    .bind(3, run.platform)
+                    .bind(4, run.workflow)
+                    .bind(5, (long) run.num_tasks)
+                    .bind(6, (long) run.tasks_failed)
+                    .bind(7, run.makespan)
+                    .bind(8, run.energy)
+                    .run();
+            run_key = (long) sqlite3_last_insert_rowid(connection);
+
+            PreparedStatement parameter_statement(connection, "INSERT INTO parameters VALUES (?, ?, ?)");
+            for (auto const &parameter: parameters) {
+                parameter_statement.bind(1, run_key).bind(2, parameter.first).bind(3, parameter.second).run();
+            }
+            PreparedStatement host_statement(connection, "INSERT INTO hosts VALUES (?, ?, ?, ?, ?)");
+            for (auto const &host: hosts) {
+                host_statement.bind(1, run_key).bind(2, host.host_name).bind(3, (long) host.num_cores).bind(4, host.energy).bind(5, host.power).run();
+            }
+            PreparedStatement task_statement(connection, "INSERT INTO tasks VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+            for (auto const &task: tasks) {
+                task_statement.bind(1, run_key)
+                        .bind(2, task.task_id)
+                        .bind(3, task.host_name)
+                        .bind(4, (long) task.num_cores)
+                        .bind(5, task.start_date)
+                        .bind(6, task.end_date)
+                        .bind(7, task.compute_time)
+                        .bind(8, task.io_input_time)
+                        .bind(9, task.io_output_time)
+                        .bind(10, (long) task.failures)
+                        .run();
+            }
+            PreparedStatement metric_statement(connection, "INSERT INTO metrics VALUES (?, ?, ?)");
+            for (auto const &metric: metrics) {
+                metric_statement.bind(1, run_key).bind(2, metric.first).bind(3, metric.second).run();
+            }
+            execute(connection, "COMMIT");
+        } catch (std::runtime_error &) {
+            sqlite3_exec(connection, "ROLLBACK", nullptr, nullptr, nullptr);
+            throw;
+        }
+        return run_key;
+    }
+
+#endif
+
+}// namespace wrench
@@ -0,0 +1,108 @@
+
+#include <cmath>
+
+#include "RuntimePredictor.h"
+
+namespace wrench {
+
+    /**
+     * @brief Constructor
+     *
+     * @param alpha: the weight of the latest observation in the moving averages, in (0,1]
+     */
+    RuntimePredictor::RuntimePredictor(double alpha) : alpha(alpha) {}
+
+    /**
+     * @brief Predict the compute time of a task
+     *
+     * @param category: the task category index
+     * @param flops: the task flops
+     * @param speed: the speed of the core the task runs on, in flop/sec
+     * @return a time in seconds
+     */
+    double RuntimePredictor::predictComputeTime(unsigned int category, double flops, double speed) const {
+        auto const &model = (category < this->models.size() and this->models[category].count > 0) ? this->models[category] : this->global_model;
+        double ratio = model.compute_ratio;
+        return ratio * flops / speed;
+    }
+
+    /**
+     * @brief Predict the I/O time of a task (reading its inputs and writing its outputs)
+     *
+     * @param category: the task category index
+     * @param bytes: the number of bytes the task reads and writes
+     * @return a time in seconds
+     */
+    double RuntimePredictor::predictIOTime(unsigned int category, double bytes) const {
+        auto const &model = (category < this->models.size() and this->models[category].count > 0) ? this->models[category] : this->global_model;
+        double time_per_byte = model.io_time_per_byte;
+        return time_per_byte * bytes;
+    }
+
+    /**
+     * @brief Learn from a completed task
+     *
+     * @param category: the task category index
+     * @param flops: the task flops
+     * @param speed: the speed of the core the task ran on, in flop/sec
+     * @param bytes: the number of bytes the task read and wrote
+     * @param compute_time: the observed compute time, in seconds
+     * @param io_time: the observed I/O time, in seconds
+     * @param predicted_compute_time: the compute time that was predicted when the task was submitted
+     * @param predicted_io_time: the I/O time that was predicted when the task was submitted
+     */
+    void RuntimePredictor::observe(unsigned int category, double flops, double speed, double bytes,
+                                   double compute_time, double io_time,
+                                   double predicted_compute_time, double predicted_io_time) {
+        this->num_observations++;
+        this->compute_time_absolute_error += std::fabs(predicted_compute_time - compute_time);
+        this->static_compute_time_absolute_error += std::fabs(flops / speed - compute_time);
+        this->io_time_absolute_error += std::fabs(predicted_io_time - io_time);
+        this->total_compute_time += compute_time;
+        this->total_io_time += io_time;
+
+        if (category >= this->models.size()) {
+            this->models.resize(category + 1);
+        }
+        double ratio = (flops > 0.0) ? compute_time * speed / flops : 1.0;
+        double time_per_byte = (bytes > 0.0) ? io_time / bytes : 0.0;
+        for (auto model: {&this->models[category], &this->global_model}) {
+            if (model->count == 0) {
+                model->compute_ratio = ratio;
+                model->io_time_per_byte = time_per_byte;
+            } else {
+                model->compute_ratio += this->alpha * (ratio - model->compute_ratio);
+                model->io_time_per_byte += this->alpha * (time_per_byte - model->io_time_per_byte);
+            }
+            model->count++;
+        }
+    }
+
+    /**
+     * @brief Get the error of the compute time predictions so far, relative to the observed compute time
+     *
+     * @return a weighted mean absolute percentage error, in [0,+inf)
+     */
+    double RuntimePredictor::getComputeTimeError() const {
+        return (this->total_compute_time > 0.0) ? this->compute_time_absolute_error / this->total_compute_time : 0.0;
+    }
+
+    /**
+     * @brief Get the error the static flops/speed estimate would have made so far, for comparison
+     *
+     * @return a weighted mean absolute percentage error, in [0,+inf)
+     */
+    double RuntimePredictor::getStaticComputeTimeError() const {
+        return (this->total_compute_time > 0.0) ? this->static_compute_time_absolute_error / this->total_compute_time : 0.0;
+    }
+
+    /**
+     * @brief Get the error of the I/O time predictions so far, relative to the observed I/O time
+     *
+     * @return a weighted mean absolute percentage error, in [0,+inf)
+     */
+    double RuntimePredictor::getIOTimeError() const {
+        return (this->total_io_time > 0.0) ? this->io_time_absolute_error / this->total_io_time : 0.0;
+    }
+
+}// namespace wrench
@@ -0,0 +1,149 @@
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "SchedulePlan.h"
+
+namespace wrench {
+
+    /**
+     * @brief Constructor, which reads and validates a plan file
+     *
+     * @param path: the path of the plan file
+     * @param task_graph_store: the task metadata of the workflow the plan is for
+     *
+     * @throw std::invalid_argument
+     */
+    SchedulePlan::SchedulePlan(const std::string &path, const TaskGraphStore &task_graph_store) {
+        std::ifstream file(path);
+        if (not file.is_open()) {
+            throw std::invalid_argument("SchedulePlan::SchedulePlan(): Cannot open " + path);
+        }
+        auto const &slot_names = getSlotNames();
+        this->planned_tasks.resize(task_graph_store.getNumTasks());
+        std::vector<bool> planned(task_graph_store.getNumTasks(), false);
+        std::string line;
+        std::getline(file, line);
+        while (std::getline(file, line)) {
+            if (line.empty()) {
+                continue;
+            }
+            std::istringstream fields(line);
+            std::vector<std::string> values;
+            std::string value;
+            while (std::getline(fields, value, ',')) {
+                values.push_back(value);
+            }
+            if (values.size() != 7) {
+                throw std::invalid_argument("SchedulePlan::SchedulePlan(): Invalid line in " + path + ": " + line);
+            }
+            auto task_index = task_graph_store.getTaskIndex(values[0]);
+            auto slot = std::find(slot_names.begin(), slot_names.end(), values[1]);
+            if (slot == slot_names.end()) {
+                throw std::invalid_argument("SchedulePlan::SchedulePlan(): Unknown service " + values[1] + " in " + path);
+            }
+            PlannedTask planned_task;
+            try {
+                planned_task = {(unsigned long) (slot - slot_names.begin()), std::stoul(values[2]), std::stoul(values[3]),
+                                std::stoul(values[4]), std::stod(values[5]), std::stod(values[6])};
+            } catch (std::exception &) {
+                throw std::invalid_argument("SchedulePlan::SchedulePlan(): Invalid line in " + path + ": " + line);
+            }
+            if (planned_task.num_cores < task_graph_store.task_min_cores[task_index] or
+                planned_task.num_cores > task_graph_store.task_max_cores[task_index]) {
+                throw std::invalid_argument("SchedulePlan::SchedulePlan(): Invalid number of cores for task " + values[0] +
+                                            " in " + path);
+            }
+            this->planned_tasks[task_index] = planned_task;
+            planned[task_index] = true;
+        }
+        auto unplanned = std::find(planned.begin(), planned.end(), false);
+        if (unplanned != planned.end()) {
+            throw std::invalid_argument("SchedulePlan::SchedulePlan(): Task " +
+                                        task_graph_store.tasks[unplanned - planned.begin()]->getID() + " is not in " + path);
+        }
+        checkDependencies(path, task_graph_store);
+    }
+
+    /**
+     * @brief Check that the plan can be executed: each task of a slot starts after the previous one in the
+     *        slot order, and after its parents, so the plan deadlocks if these constraints have a cycle
+     *        (e.g., a task ordered before one of its ancestors on its slot, or across slots)
+     *
+     * @param path: the path of the plan file
+     * @param task_graph_store: the task metadata of the workflow the plan is for
+     *
+     * @throw std::invalid_argument
+     */
+    void SchedulePlan::checkDependencies(const std::string &path, const TaskGraphStore &task_graph_store) const {
+        auto num_tasks = this->planned_tasks.size();
+        // The tasks of each slot in the order the WMS starts them (by order, then by task index)
+        std::vector<std::vector<std::pair<unsigned long, unsigned long>>> slot_orders(getSlotNames().size());
+        for (unsigned long i = 0; i < num_tasks; i++) {
+            slot_orders[this->planned_tasks[i].slot].emplace_back(this->planned_tasks[i].order, i);
+        }
+        std::vector<long> next_on_slot(num_tasks, -1);
+        std::vector<unsigned long> num_waits(num_tasks, 0);
+        for (auto &slot_order: slot_orders) {
+            std::sort(slot_order.begin(), slot_order.end());
+            for (unsigned long position = 1; position < slot_order.size(); position++) {
+                next_on_slot[slot_order[position - 1].second] = (long) slot_order[position].second;
+                num_waits[slot_order[position].second]++;
+            }
+        }
+        for (unsigned long i = 0; i < num_tasks; i++) {
+            num_waits[i] += task_graph_store.parent_offsets[i + 1] - task_graph_store.parent_offsets[i];
+        }
+
+        // Kahn's algorithm: the tasks that can start are released one after the other
+        std::vector<unsigned long> startable;
+        for (unsigned long i = 0; i < num_tasks; i++) {
+            if (num_waits[i] == 0) {
+                startable.push_back(i);
+            }
+        }
+        unsigned long num_started = 0;
+        while (not startable.empty()) {
+            auto task = startable.back();
+            startable.pop_back();
+            num_started++;
+            auto release = [&num_waits, &startable](unsigned long waiting_task) {
+                if (--num_waits[waiting_task] == 0) {
+                    startable.push_back(waiting_task);
+                }
+            };
+            for (auto child = task_graph_store.child_offsets[task]; child < task_graph_store.child_offsets[task + 1]; child++) {
+                release(task_graph_store.children[child]);
+            }
+            if (next_on_slot[task] >= 0) {
+                release(next_on_slot[task]);
+            }
+        }
+        if (num_started < num_tasks) {
+            // Report a task that waits for a parent that cannot start
+            for (unsigned long i = 0; i < num_tasks; i++) {
+                for (auto parent = task_graph_store.parent_offsets[i]; num_waits[i] > 0 and parent < task_graph_store.parent_offsets[i + 1]; parent++) {
+                    if (num_waits[task_graph_store.parents[parent]] > 0) {
+                        throw std::invalid_argument("SchedulePlan::SchedulePlan(): Task " + task_graph_store.tasks[i]->getID() +
+                                                    " can never start: the slot orders of " + path +
+                                                    " contradict its dependencies");
+                    }
+                }
+            }
+            throw std::invalid_argument("SchedulePlan::SchedulePlan(): The slot orders of " + path + " contradict the task dependencies");
+        }
+    }
+
+    /**
+     * @brief Get the names of the compute service slots, in the order of the WMS service slots
+     *
+     * @return the slot names
+     */
+    const std::vector<std::string> &SchedulePlan::getSlotNames() {
+        static const std::vector<std::string> slot_names = {"vm1", "vm2", "vm3", "pilot", "accelerator"};
+        return slot_names;
+    }
+
+}// namespace wrench
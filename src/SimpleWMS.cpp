@@ -1,5 +1,8 @@
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 
 #include "SimpleWMS.h"
 
@@ -15,20 +18,197 @@ namespace wrench {
      *        a scheduler implementation, and a list of compute services
      *
      * @param workflow: a workflow to execute
+     * @param task_graph_store: the compact metadata of the workflow
      * @param batch_compute_service: a batch compute service available to run jobs
      * @param cloud_compute_service: a cloud compute service available to run jobs
      * @param storage_service: a storage service available to store files
      * @param hostname: the name of the host on which to start the WMS
      */
     SimpleWMS::SimpleWMS(const std::shared_ptr<Workflow> &workflow,
+                         const std::shared_ptr<TaskGraphStore> &task_graph_store,
                          const std::shared_ptr<BatchComputeService> &batch_compute_service,
                          const std::shared_ptr<CloudComputeService> &cloud_compute_service,
                          const std::shared_ptr<StorageService> &storage_service,
                          const std::string &hostname) : ExecutionController(hostname, "simple"),
                                                         workflow(workflow),
+                                                        task_graph_store(task_graph_store),
                                                         batch_compute_service(batch_compute_service),
                                                         cloud_compute_service(cloud_compute_service),
-                                                        storage_service(storage_service) {}
+                                                        storage_service(storage_service),
+                                                        accelerator_speedups(task_graph_store->getNumCategories(), 0.0),
+                                                        task_predictions(task_graph_store->getNumTasks()) {}
+
+    /**
+     * @brief Give the WMS a compute service on accelerator-equipped nodes
+     *
+     * @param accelerator_compute_service: a bare-metal compute service whose hosts are accelerator nodes
+     * @param accelerator_speedups: the task categories eligible for acceleration, and their speedup
+     *        over a CPU core (the accelerator host speed is the upper bound)
+     */
+    void SimpleWMS::setAcceleratorComputeService(const std::shared_ptr<BareMetalComputeService> &accelerator_compute_service,
+                                                 const std::map<std::string, double> &accelerator_speedups) {
+        this->accelerator_compute_service = accelerator_compute_service;
+        for (auto const &speedup: accelerator_speedups) {
+            auto category = this->task_graph_store->getCategoryIndex(speedup.first);
+            if (category >= 0) {
+                this->accelerator_speedups[category] = speedup.second;
+            }
+        }
+    }
+
+    /**
+     * @brief Replace the online runtime predictor of the WMS (e.g., to use a different weighting)
+     *
+     * @param runtime_predictor: a runtime predictor
+     */
+    void SimpleWMS::setRuntimePredictor(const RuntimePredictor &runtime_predictor) {
+        this->runtime_predictor = runtime_predictor;
+    }
+
+    /**
+     * @brief Give the WMS a background writer for the execution trace
+     *
+     * @param trace_writer: a writer to which a record is handed for each task completion or failure
+     */
+    void SimpleWMS::setTraceWriter(const std::shared_ptr<AsyncWriter<TaskTraceRecord>> &trace_writer) {
+        this->trace_writer = trace_writer;
+    }
+
+    /**
+     * @brief Set the recorder of the task executions and host utilization timeline
+     *
+     * @param timeline_recorder: a recorder that is told about each task submission, completion and failure
+     */
+    void SimpleWMS::setTimelineRecorder(const std::shared_ptr<TimelineRecorder> &timeline_recorder) {
+        this->timeline_recorder = timeline_recorder;
+    }
+
+    /**
+     * @brief Set the DVFS policy, which selects the pstate of the CPU hosts the WMS runs tasks on:
+     *        "performance" keeps the fastest pstate, "powersave" uses the slowest one, and "energy"
+     *        keeps the fastest pstate while ready tasks are waiting for a core and otherwise uses, on
+     *        each host, the pstate with the lowest energy per flop at the host's current load
+     *
+     * @param dvfs_policy: the policy name
+     *
+     * @throw std::invalid_argument
+     */
+    void SimpleWMS::setDvfsPolicy(const std::string &dvfs_policy) {
+        if (dvfs_policy != "performance" and dvfs_policy != "powersave" and dvfs_policy != "energy") {
+            throw std::invalid_argument("SimpleWMS::setDvfsPolicy(): Unknown DVFS policy " + dvfs_policy);
+        }
+        this->dvfs_policy = dvfs_policy;
+    }
+
+    /**
+     * @brief Set how the tasks of a node are placed on its CPU sockets: "spread" evenly over the sockets
+     *        (the OS default), or "consolidate"d onto as few sockets as possible (e.g., with CPU affinity),
+     *        so that idle sockets can be power-gated. When consolidating, each ready task goes to the
+     *        compute service where it adds the least power, i.e., preferably to a socket that is already
+     *        awake, rather than to the first one with an idle core.
+     *
+     * @param socket_placement: the placement name
+     *
+     * @throw std::invalid_argument
+     */
+    void SimpleWMS::setSocketPlacement(const std::string &socket_placement) {
+        if (socket_placement != "spread" and socket_placement != "consolidate") {
+            throw std::invalid_argument("SimpleWMS::setSocketPlacement(): Unknown socket placement " + socket_placement);
+        }
+        this->consolidate_sockets = socket_placement == "consolidate";
+    }
+
+    /**
+     * @brief Set the task placement policy: "first-fit" (each ready task goes to the first compute service
+     *        with an idle core), or "consolidate" (each ready task goes where it adds the least power, so
+     *        that busy nodes fill up before idle ones are used). When consolidating, the tasks of the pilot
+     *        job are pinned to its busiest awake node, and its nodes that run no task are powered down (if
+     *        they can be) until a task needs them.
+     *
+     * @param placement_policy: the policy name
+     *
+     * @throw std::invalid_argument
+     */
+    void SimpleWMS::setPlacementPolicy(const std::string &placement_policy) {
+        if (placement_policy != "first-fit" and placement_policy != "consolidate") {
+            throw std::invalid_argument("SimpleWMS::setPlacementPolicy(): Unknown placement policy " + placement_policy);
+        }
+        this->consolidate_placement = placement_policy == "consolidate";
+    }
+
+    /**
+     * @brief Set how long an idle pilot job node stays up before it is powered down, with consolidated placement
+     *
+     * @param power_down_delay: a time in seconds (>= 0), or a negative value for the break-even time of each node
+     */
+    void SimpleWMS::setPowerDownDelay(double power_down_delay) {
+        this->power_down_delay = power_down_delay;
+    }
+
+    /**
+     * @brief Set the log of the WMS decisions
+     *
+     * @param decision_log: a log that is told about each task placement, pilot job request and pstate change
+     * @param stop_at_divergence: whether to abort the workflow execution at the first decision that differs
+     *                            from the baseline of the log (e.g., to find the common prefix of two policies)
+     */
+    void SimpleWMS::setDecisionLog(const std::shared_ptr<DecisionLog> &decision_log, bool stop_at_divergence) {
+        this->decision_log = decision_log;
+        this->stop_at_divergence = stop_at_divergence;
+    }
+
+    /**
+     * @brief Set the simulation rate counters, to which the WMS reports its events and the time it spends
+     *        making decisions
+     *
+     * @param profiler: a profiler
+     */
+    void SimpleWMS::setProfiler(const std::shared_ptr<SimulationProfiler> &profiler) {
+        this->profiler = profiler;
+    }
+
+    /**
+     * @brief Hand the placement of the ready tasks over to an external scheduling policy
+     *
+     * @param policy_channel: the channel to the policy
+     */
+    void SimpleWMS::setPolicyChannel(const std::shared_ptr<PolicyChannel> &policy_channel) {
+        this->policy_channel = policy_channel;
+    }
+
+    /**
+     * @brief Execute a static schedule plan: each task runs on the compute service slot, with the number
+     *        of cores and in the pstate given by the plan, and the tasks of each slot start in the plan
+     *        order (the DVFS policy is then not applied)
+     *
+     * @param schedule_plan: a plan for the workflow
+     *
+     * @throw std::invalid_argument
+     */
+    void SimpleWMS::setSchedulePlan(const std::shared_ptr<SchedulePlan> &schedule_plan) {
+        auto const &planned_tasks = schedule_plan->getPlannedTasks();
+        this->plan_slot_queues.assign(SchedulePlan::getSlotNames().size(), {});
+        for (unsigned long i = 0; i < planned_tasks.size(); i++) {
+            if (planned_tasks[i].slot == SchedulePlan::getSlotNames().size() - 1 and not this->accelerator_compute_service) {
+                throw std::invalid_argument("SimpleWMS::setSchedulePlan(): Task " + this->task_graph_store->tasks[i]->getID() +
+                                            " is planned on accelerator nodes, but the platform has none");
+            }
+            this->plan_slot_queues[planned_tasks[i].slot].insert({planned_tasks[i].order, i});
+        }
+        this->schedule_plan = schedule_plan;
+    }
+
+    /**
+     * @brief Slow down the tasks that share a node according to an interference model
+     *
+     * @param interference_model: a co-location interference model
+     * @param avoid_interference: whether ready tasks go to the compute service where they are slowed down
+     *        the least, rather than to the first one with an idle core
+     */
+    void SimpleWMS::setInterferenceModel(const std::shared_ptr<InterferenceModel> &interference_model, bool avoid_interference) {
+        this->interference_model = interference_model;
+        this->avoid_interference = avoid_interference;
+    }
 
     /**
      * @brief main method of the SimpleWMS daemon
@@ -46,6 +226,12 @@ namespace wrench {
         // Create a job manager
         auto job_manager = this->createJobManager();
 
+        // All files are read/written from the one storage service
+        this->file_locations.reserve(this->task_graph_store->getNumFiles());
+        for (auto const &f: this->task_graph_store->files) {
+            this->file_locations.push_back(wrench::FileLocation::LOCATION(this->storage_service, f));
+        }
+
         // Create a data movement manager
         auto data_movement_manager = this->createDataMovementManager();
 
@@ -53,23 +239,84 @@ namespace wrench {
         auto vm1 = this->cloud_compute_service->createVM(28, ram * GB);
         auto vm1_cs = this->cloud_compute_service->startVM(vm1);
         this->core_utilization_map[vm1_cs] = 28;
+        this->total_cores_map[vm1_cs] = 28;
+        this->power_profile_map[vm1_cs] = HostPowerProfile::fromHost(this->cloud_compute_service->getVMPhysicalHostname(vm1));
+        this->physical_hosts_map[vm1_cs] = {{this->cloud_compute_service->getVMPhysicalHostname(vm1), 28}};
+        this->cpu_reference_speed = this->power_profile_map[vm1_cs].speed;
 
         auto vm2 = this->cloud_compute_service->createVM(28, ram * GB);
         auto vm2_cs = this->cloud_compute_service->startVM(vm2);
         this->core_utilization_map[vm2_cs] = 28;
+        this->total_cores_map[vm2_cs] = 28;
+        this->power_profile_map[vm2_cs] = HostPowerProfile::fromHost(this->cloud_compute_service->getVMPhysicalHostname(vm2));
+        this->physical_hosts_map[vm2_cs] = {{this->cloud_compute_service->getVMPhysicalHostname(vm2), 28}};
 
         auto vm3 = this->cloud_compute_service->createVM(28, ram * GB);
         auto vm3_cs = this->cloud_compute_service->startVM(vm3);
         this->core_utilization_map[vm3_cs] = 28;
+        this->total_cores_map[vm3_cs] = 28;
+        this->power_profile_map[vm3_cs] = HostPowerProfile::fromHost(this->cloud_compute_service->getVMPhysicalHostname(vm3));
+        this->physical_hosts_map[vm3_cs] = {{this->cloud_compute_service->getVMPhysicalHostname(vm3), 28}};
+
+        this->vm_compute_services = {vm1_cs, vm2_cs, vm3_cs};
+
+        // Tasks run on the cores their recipe gives them: one that needs more cores than a VM would never start
+        for (unsigned long i = 0; i < this->task_graph_store->getNumTasks(); i++) {
+            if (this->task_graph_store->task_min_cores[i] > this->total_cores_map[vm1_cs]) {
+                throw std::runtime_error("SimpleWMS::main(): Task " + this->task_graph_store->tasks[i]->getID() + " needs " +
+                                         std::to_string(this->task_graph_store->task_min_cores[i]) + " cores, more than a VM has (" +
+                                         std::to_string(this->total_cores_map[vm1_cs]) + ")");
+            }
+        }
+
+        // The accelerator nodes, if any, are available for the whole execution as well
+        if (this->accelerator_compute_service) {
+            auto per_host_num_cores = this->accelerator_compute_service->getPerHostNumCores();
+            this->core_utilization_map[this->accelerator_compute_service] = this->accelerator_compute_service->getTotalNumCores();
+            this->total_cores_map[this->accelerator_compute_service] = this->core_utilization_map[this->accelerator_compute_service];
+            this->power_profile_map[this->accelerator_compute_service] = HostPowerProfile::fromHost(per_host_num_cores.begin()->first);
+        }
+
+        // Batch compute nodes that can be powered down stay so until a pilot job runs on them
+        this->batch_hosts = this->batch_compute_service->getPerHostNumCores();
+        for (auto const &host: this->batch_hosts) {
+            this->turbo_available = this->turbo_available or HostPowerProfile::getTurboPstate(host.first) >= 0;
+        }
+        for (auto const &cs: this->vm_compute_services) {
+            this->turbo_available = this->turbo_available or HostPowerProfile::getTurboPstate(this->physical_hosts_map[cs].begin()->first) >= 0;
+        }
+        std::vector<std::string> batch_hostnames;
+        for (auto const &host: this->batch_hosts) {
+            batch_hostnames.push_back(host.first);
+        }
+        powerDownBatchHosts(batch_hostnames);
+        for (auto const &hostname: Simulation::getHostnameList()) {
+            if (this->powered_down_hosts.find(hostname) == this->powered_down_hosts.end()) {
+                this->always_on_idle_power += HostPowerProfile::fromHost(hostname).idle_watts;
+            }
+        }
 
         while (true) {
-            // If a pilot job is not running on the batch service, let's submit one that asks
-            // for 3 cores on 2 compute nodes for 1 hour
+            SimulationProfiler::WmsScope wms_scope(this->profiler.get());
+
+            // If a pilot job is not running on the batch service, let's submit one, for as many nodes as
+            // minimize the predicted energy when nodes can be powered down (6 nodes otherwise), and for long
+            // enough to complete the remaining work
             if (not pilot_job) {
                 WRENCH_INFO("Creating and submitting a pilot job");
                 pilot_job = job_manager->createPilotJob();
+                this->pilot_job_num_nodes = selectPilotJobNodeCount();
+                this->pilot_job_walltime = predictPilotJobWalltime(this->pilot_job_num_nodes);
+                this->num_pilot_jobs++;
+                this->metrics["pilot_jobs"]++;
+                this->metrics["pilot_job_nodes_requested"] += (double) this->pilot_job_num_nodes;
+                recordDecision("pilot_job", std::to_string(this->pilot_job_num_nodes),
+                               std::to_string((unsigned long) this->pilot_job_walltime));
+                SimulationProfiler::SimulationScope simulation_scope(this->profiler.get());
                 job_manager->submitJob(pilot_job, this->batch_compute_service,
-                                       {{"-N", "6"}, {"-c", "28"}, {"-t", "3600000"}});
+                                       {{"-N", std::to_string(this->pilot_job_num_nodes)},
+                                        {"-c", std::to_string(this->batch_hosts.begin()->second)},
+                                        {"-t", std::to_string((unsigned long) this->pilot_job_walltime)}});
             }
 
             // Construct the list of currently available bare-metal services (on VMs and perhaps within pilot job as well)
@@ -77,11 +324,25 @@ namespace wrench {
             if (this->pilot_job_is_running) {
                 available_compute_service.insert(pilot_job->getComputeService());
             }
+            if (this->accelerator_compute_service) {
+                available_compute_service.insert(this->accelerator_compute_service);
+            }
 
             scheduleReadyTasks(workflow->getReadyTasks(), job_manager, available_compute_service);
 
-            // Wait for a workflow execution event, and process it
+            // With consolidated placement, the pilot job nodes left without tasks are powered down (external
+            // policies and schedule plans place tasks on the nodes of their choice, which therefore stay up)
+            if (this->consolidate_placement and this->pilot_job_is_running and not this->policy_channel and not this->schedule_plan) {
+                powerDownIdlePilotHosts();
+            }
+
+            if ((this->dvfs_policy != "performance" or this->turbo_available) and not this->schedule_plan) {
+                applyDvfsPolicy(available_compute_service, not workflow->getReadyTasks().empty());
+            }
+
+            // Wait for a workflow execution event, and process it (the event callbacks account for their own time)
             try {
+                SimulationProfiler::SimulationScope simulation_scope(this->profiler.get());
                 this->waitForAndProcessNextEvent();
             } catch (ExecutionException &e) {
                 WRENCH_INFO("Error while getting next execution event (%s)... ignoring and trying again",
@@ -102,6 +363,51 @@ namespace wrench {
             WRENCH_INFO("Workflow execution is incomplete!");
         }
 
+        this->metrics["predictor_observations"] = (double) this->runtime_predictor.getNumObservations();
+        this->metrics["predictor_compute_time_error"] = this->runtime_predictor.getComputeTimeError();
+        this->metrics["predictor_static_compute_time_error"] = this->runtime_predictor.getStaticComputeTimeError();
+        this->metrics["predictor_io_time_error"] = this->runtime_predictor.getIOTimeError();
+        WRENCH_INFO("Runtime prediction error: %.2lf%% compute (%.2lf%% with static estimates), %.2lf%% I/O",
+                    100 * this->metrics["predictor_compute_time_error"],
+                    100 * this->metrics["predictor_static_compute_time_error"],
+                    100 * this->metrics["predictor_io_time_error"]);
+
+        if (this->interference_model and this->metrics.count("interference_tasks")) {
+            this->metrics["interference_mean_slowdown"] = this->metrics["interference_total_slowdown"] / this->metrics["interference_tasks"];
+            WRENCH_INFO("Co-location interference: mean slowdown %.3lf, %.2lf s of extra compute time",
+                        this->metrics["interference_mean_slowdown"], this->metrics["interference_extra_compute_time"]);
+        }
+
+        if (this->consolidate_placement and this->metrics.count("placement_estimated_energy")) {
+            this->metrics["placement_estimated_savings"] = this->metrics["first_fit_estimated_energy"] - this->metrics["placement_estimated_energy"];
+            WRENCH_INFO("Consolidated placement: the tasks are estimated to add %.2lf J (%.2lf J with first-fit placement)",
+                        this->metrics["placement_estimated_energy"], this->metrics["first_fit_estimated_energy"]);
+        }
+
+        if (this->schedule_plan and not this->plan_deviations.empty()) {
+            auto completed = this->metrics["plan_tasks_completed"];
+            this->metrics["plan_mean_start_delay"] = this->metrics["plan_total_start_delay"] / completed;
+            this->metrics["plan_mean_end_delay"] = this->metrics["plan_total_end_delay"] / completed;
+            this->metrics["plan_actual_makespan"] = Simulation::getCurrentSimulatedDate();
+            WRENCH_INFO("Schedule plan: makespan %.2lf (planned %.2lf), mean start delay %.2lf, %.0lf pstate deviations",
+                        this->metrics["plan_actual_makespan"], this->metrics["plan_planned_makespan"],
+                        this->metrics["plan_mean_start_delay"], this->metrics["plan_pstate_deviations"]);
+        }
+
+        if (this->decision_log) {
+            this->metrics["decisions"] = (double) this->decision_log->getNumDecisions();
+            if (this->decision_log->hasBaseline()) {
+                this->metrics["first_divergent_decision"] = (double) this->decision_log->getFirstDivergence();
+                this->metrics["first_divergence_date"] = this->decision_log->getFirstDivergenceDate();
+                WRENCH_INFO("First decision that differs from the baseline: %ld (at date %.2lf)",
+                            this->decision_log->getFirstDivergence(), this->decision_log->getFirstDivergenceDate());
+            }
+        }
+
+        if (this->policy_channel) {
+            this->policy_channel->endEpisode(observePolicyState({}, getServiceSlots({})));
+        }
+
         WRENCH_INFO("WMS terminating");
 
         return 0;
@@ -113,11 +419,54 @@ namespace wrench {
      * @param event: a workflow execution event
      */
     void SimpleWMS::processEventStandardJobFailure(std::shared_ptr<StandardJobFailedEvent> event) {
+        SimulationProfiler::WmsScope wms_scope(this->profiler.get());
+        if (this->profiler) {
+            this->profiler->countWmsEvent();
+        }
         auto job = event->standard_job;
         TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_RED);
         WRENCH_INFO("Task %s has failed", (*job->getTasks().begin())->getID().c_str());
         WRENCH_INFO("failure cause: %s", event->failure_cause->toString().c_str());
         TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_GREEN);
+
+        auto &prediction = this->task_predictions[this->task_graph_store->getTaskIndex(*job->getTasks().begin())];
+        if (this->interference_model and job->getParentComputeService() != this->accelerator_compute_service) {
+            auto category = this->task_graph_store->task_categories[this->task_graph_store->getTaskIndex(*job->getTasks().begin())];
+            this->memory_pressure_map[job->getParentComputeService()] -=
+                    this->interference_model->getIntensity(category) * (double) prediction.num_cores;
+        }
+        if (not prediction.hostname.empty()) {
+            this->pilot_host_busy_cores[prediction.hostname] -= prediction.num_cores;
+            prediction.hostname.clear();
+        }
+        removeRunningTask(this->task_graph_store->getTaskIndex(*job->getTasks().begin()));
+
+        // A planned task that fails (e.g., when the pilot job expires) runs again in its place in the plan
+        if (this->schedule_plan) {
+            auto task_index = this->task_graph_store->getTaskIndex(*job->getTasks().begin());
+            auto const &planned_task = this->schedule_plan->getPlannedTasks()[task_index];
+            this->plan_slot_queues[planned_task.slot].insert({planned_task.order, task_index});
+        }
+
+        if (this->trace_writer) {
+            TaskTraceRecord record;
+            record.date = Simulation::getCurrentSimulatedDate();
+            record.task_index = this->task_graph_store->getTaskIndex(*job->getTasks().begin());
+            record.failed = true;
+            this->trace_writer->write(std::move(record));
+        }
+        if (this->timeline_recorder) {
+            auto task = *job->getTasks().begin();
+            auto task_index = this->task_graph_store->getTaskIndex(task);
+            auto now = Simulation::getCurrentSimulatedDate();
+            if (task->getExecutionHistory().empty()) {
+                this->timeline_recorder->taskEnded(task_index, "", 0, now, now, true);
+            } else {
+                auto execution = task->getExecutionHistory().top();
+                this->timeline_recorder->taskEnded(task_index, execution.physical_execution_host, execution.num_cores_allocated,
+                                                   execution.task_start, now, true);
+            }
+        }
     }
 
     /**
@@ -126,13 +475,64 @@ namespace wrench {
     * @param event: a workflow execution event
     */
     void SimpleWMS::processEventStandardJobCompletion(std::shared_ptr<StandardJobCompletedEvent> event) {
+        SimulationProfiler::WmsScope wms_scope(this->profiler.get());
+        if (this->profiler) {
+            this->profiler->countWmsEvent();
+        }
         auto job = event->standard_job;
         TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_BLUE);
         WRENCH_INFO("Task %s has COMPLETED (on service %s)",
                     (*job->getTasks().begin())->getID().c_str(),
                     job->getParentComputeService()->getName().c_str());
         TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_GREEN);
-        this->core_utilization_map[job->getParentComputeService()]++;
+
+        // Learn from the task execution
+        auto task = *job->getTasks().begin();
+        auto task_index = this->task_graph_store->getTaskIndex(task);
+        auto execution = task->getExecutionHistory().top();
+        this->core_utilization_map[job->getParentComputeService()] += execution.num_cores_allocated;
+        if (this->schedule_plan) {
+            recordPlanDeviation(task_index, execution.task_start, execution.task_end,
+                                Simulation::getCurrentPstate(execution.physical_execution_host));
+        }
+        if (this->trace_writer) {
+            this->trace_writer->write({Simulation::getCurrentSimulatedDate(), task_index, false,
+                                       execution.physical_execution_host, execution.num_cores_allocated,
+                                       execution.task_start, execution.task_end});
+        }
+        if (this->timeline_recorder) {
+            this->timeline_recorder->taskEnded(task_index, execution.physical_execution_host, execution.num_cores_allocated,
+                                               execution.task_start, execution.task_end, false);
+        }
+        auto &prediction = this->task_predictions[task_index];
+        if (not prediction.hostname.empty()) {
+            this->pilot_host_busy_cores[prediction.hostname] -= prediction.num_cores;
+            prediction.hostname.clear();
+        }
+        removeRunningTask(task_index);
+        if (this->interference_model and job->getParentComputeService() != this->accelerator_compute_service) {
+            this->memory_pressure_map[job->getParentComputeService()] -=
+                    this->interference_model->getIntensity(this->task_graph_store->task_categories[task_index]) *
+                    (double) prediction.num_cores;
+            this->metrics["interference_tasks"]++;
+            this->metrics["interference_total_slowdown"] += prediction.slowdown;
+            this->metrics["interference_max_slowdown"] = std::max(this->metrics["interference_max_slowdown"], prediction.slowdown);
+            this->metrics["interference_extra_compute_time"] += (execution.computation_end - execution.computation_start -
+                                                                 prediction.wake_up_latency) *
+                                                                (1.0 - 1.0 / prediction.slowdown);
+        }
+        if (prediction.speed > 0.0) {
+            // The predictor learns the runtimes of the tasks running alone on a node
+            double compute_time = (execution.computation_end - execution.computation_start - prediction.wake_up_latency) /
+                                  prediction.slowdown;
+            double io_time = (execution.read_input_end - execution.read_input_start) +
+                             (execution.write_output_end - execution.write_output_start);
+            auto const &store = this->task_graph_store;
+            this->runtime_predictor.observe(store->task_categories[task_index], store->task_flops[task_index], prediction.speed,
+                                            store->task_input_bytes[task_index] + store->task_output_bytes[task_index],
+                                            compute_time, io_time, prediction.compute_time / prediction.slowdown, prediction.io_time);
+            prediction.speed = 0.0;
+        }
     }
 
 
@@ -142,12 +542,56 @@ namespace wrench {
     * @param event: a workflow execution event
     */
     void SimpleWMS::processEventPilotJobStart(std::shared_ptr<PilotJobStartedEvent> event) {
+        SimulationProfiler::WmsScope wms_scope(this->profiler.get());
+        if (this->profiler) {
+            this->profiler->countWmsEvent();
+        }
         TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_BLUE);
         WRENCH_INFO("The pilot job has started (it exposes bare-metal compute service %s)",
                     event->pilot_job->getComputeService()->getName().c_str());
         TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_GREEN);
-        this->pilot_job_is_running = true;
-        this->core_utilization_map[this->pilot_job->getComputeService()] = event->pilot_job->getComputeService()->getTotalNumIdleCores();
+        this->pilot_job_start_date = Simulation::getCurrentSimulatedDate();
+        auto pilot_cs = this->pilot_job->getComputeService();
+        this->core_utilization_map[pilot_cs] = event->pilot_job->getComputeService()->getTotalNumIdleCores();
+        this->total_cores_map[pilot_cs] = this->core_utilization_map[pilot_cs];
+        this->physical_hosts_map[pilot_cs] = pilot_cs->getPerHostNumCores();
+
+        // Powered-down nodes are usable once booted
+        std::vector<std::string> hostnames;
+        for (auto const &host: this->physical_hosts_map[pilot_cs]) {
+            hostnames.push_back(host.first);
+        }
+        double boot_time = powerUpBatchHosts(hostnames);
+        this->power_profile_map[pilot_cs] = HostPowerProfile::fromHost(hostnames.front());
+        if (boot_time > 0.0) {
+            WRENCH_INFO("Waiting %.0lf seconds for the pilot job nodes to boot", boot_time);
+            this->setTimer(this->pilot_job_start_date + boot_time, "pilot_job_booted:" + std::to_string(this->num_pilot_jobs));
+        } else {
+            this->pilot_job_is_running = true;
+        }
+    }
+
+    /**
+    * @brief Process a TimerEvent event, i.e., the end of the boot of the pilot job nodes
+    *
+    * @param event: a workflow execution event
+    */
+    void SimpleWMS::processEventTimer(std::shared_ptr<TimerEvent> event) {
+        SimulationProfiler::WmsScope wms_scope(this->profiler.get());
+        if (this->profiler) {
+            this->profiler->countWmsEvent();
+        }
+        // The timers of pilot jobs that have expired since are ignored
+        if (this->pilot_job and event->content == "pilot_job_booted:" + std::to_string(this->num_pilot_jobs)) {
+            WRENCH_INFO("The pilot job nodes have booted");
+            this->pilot_job_is_running = true;
+        }
+        std::string node_prefix = "pilot_node_booted:" + std::to_string(this->num_pilot_jobs) + ":";
+        if (this->pilot_job and event->content.compare(0, node_prefix.size(), node_prefix) == 0) {
+            auto hostname = event->content.substr(node_prefix.size());
+            WRENCH_INFO("Pilot job node %s has booted", hostname.c_str());
+            this->booting_hosts.erase(hostname);
+        }
     }
 
     /**
@@ -156,13 +600,27 @@ namespace wrench {
     * @param event: a workflow execution event
     */
     void SimpleWMS::processEventPilotJobExpiration(std::shared_ptr<PilotJobExpiredEvent> event) {
+        SimulationProfiler::WmsScope wms_scope(this->profiler.get());
+        if (this->profiler) {
+            this->profiler->countWmsEvent();
+        }
         TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_RED);
         WRENCH_INFO("The pilot job has expired (it was exposing bare-metal compute service %s)",
                     event->pilot_job->getComputeService()->getName().c_str());
         TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_GREEN);
 
         this->pilot_job_is_running = false;
+        std::vector<std::string> hostnames;
+        for (auto const &host: this->physical_hosts_map[this->pilot_job->getComputeService()]) {
+            hostnames.push_back(host.first);
+        }
+        powerDownBatchHosts(hostnames);
+        this->booting_hosts.clear();
+        this->pilot_host_idle_since.clear();
         this->core_utilization_map.erase(this->pilot_job->getComputeService());
+        this->total_cores_map.erase(this->pilot_job->getComputeService());
+        this->power_profile_map.erase(this->pilot_job->getComputeService());
+        this->physical_hosts_map.erase(this->pilot_job->getComputeService());
         this->pilot_job = nullptr;
     }
 
@@ -171,7 +629,8 @@ namespace wrench {
      *        simple/naive scheduling approach, that greedily runs tasks on idle cores of whatever
      *        compute services are available right now, using 1 core per task. Obviously, much more
      *        sophisticated approaches/algorithms are possible. But this is sufficient for the sake
-     *        of an example.
+     *        of an example. Tasks whose category is eligible for acceleration run on an accelerator
+     *        slot instead whenever that is expected to consume less energy than the CPU core.
      *
      * @param ready_task: the ready tasks to schedule
      * @param job_manager: a job manager
@@ -187,40 +646,1101 @@ namespace wrench {
         }
 
         WRENCH_INFO("Trying to schedule %zu ready tasks", ready_tasks.size());
+        if (this->profiler) {
+            this->profiler->recordReadyTasks(ready_tasks.size());
+        }
+        if (this->policy_channel and scheduleTasksWithPolicy(ready_tasks, job_manager, compute_services)) {
+            return;
+        }
+        if (this->schedule_plan) {
+            scheduleTasksWithPlan(job_manager, compute_services);
+            return;
+        }
 
+        bool accelerator_available = this->accelerator_compute_service and
+                                     compute_services.find(this->accelerator_compute_service) != compute_services.end();
+
+        auto pilot_cs = this->pilot_job_is_running ? this->pilot_job->getComputeService() : nullptr;
         unsigned long num_tasks_scheduled = 0;
+        // With consolidated placement, the cores of the tasks of this round that wait for pilot job nodes to boot
+        unsigned long num_cores_waiting_for_boot = 0;
         for (auto const &task: ready_tasks) {
-            bool scheduled = false;
+            auto task_index = this->task_graph_store->getTaskIndex(task);
+            auto num_cores = this->task_graph_store->task_min_cores[task_index];
+            std::shared_ptr<BareMetalComputeService> target_cs = nullptr;
+            std::string target_host;
+            double target_cost = 0.0;
+            // The energy the task would add with first-fit placement, for comparison with consolidated placement
+            double first_fit_energy = -1.0;
             for (auto const &cs: compute_services) {
-                if (this->core_utilization_map[cs] > 0) {
-                    // Specify that ALL files are read/written from the one storage service
-                    std::map<std::shared_ptr<DataFile>, std::shared_ptr<FileLocation>> file_locations;
-                    for (auto const &f: task->getInputFiles()) {
-                        file_locations[f] = wrench::FileLocation::LOCATION(this->storage_service, f);
+                if (cs == this->accelerator_compute_service or not canStartTask(task_index, cs)) {
+                    continue;
+                }
+                // Backfill the pilot job only with tasks predicted to complete before it expires
+                if (exceedsPilotJobWalltime(task_index, cs)) {
+                    continue;
+                }
+                if (not this->consolidate_placement and not this->avoid_interference and not this->consolidate_sockets) {
+                    target_cs = cs;
+                    break;
+                }
+                // Otherwise, the service where the task adds the least energy (a busy node or an awake socket) or
+                // slows down the least
+                std::string host;
+                double cost;
+                if (this->consolidate_placement) {
+                    if (first_fit_energy < 0.0) {
+                        first_fit_energy = estimateTaskEnergy(task_index, cs, this->power_profile_map[cs].speed);
                     }
-                    for (auto const &f: task->getOutputFiles()) {
-                        file_locations[f] = wrench::FileLocation::LOCATION(this->storage_service, f);
+                    if (cs == pilot_cs) {
+                        host = selectPilotHost(cs, num_cores, num_cores_waiting_for_boot);
+                        if (host.empty()) {
+                            continue;
+                        }
                     }
-                    try {
-                        auto job = job_manager->createStandardJob(task, file_locations);
-                        WRENCH_INFO(
-                                "Submitting task %s to compute service %s", task->getID().c_str(),
-                                cs->getName().c_str());
-                        job_manager->submitJob(job, cs);
-                        this->core_utilization_map[cs]--;
-                        num_tasks_scheduled++;
-                        scheduled = true;
-                    } catch (ExecutionException &e) {
-                        WRENCH_INFO("WARNING: Was not able to submit task %s, likely due to the pilot job having expired "
-                                    "(I should get a notification of its expiration soon)",
-                                    task->getID().c_str());
+                    cost = estimateTaskEnergy(task_index, cs, this->power_profile_map[cs].speed, host);
+                } else {
+                    cost = this->consolidate_sockets ? estimateTaskEnergy(task_index, cs, this->power_profile_map[cs].speed)
+                                                     : predictSlowdown(task_index, cs);
+                }
+                if (not target_cs or cost < target_cost) {
+                    target_cs = cs;
+                    target_host = host;
+                    target_cost = cost;
+                }
+            }
+
+            double accelerator_speed = getAcceleratorSpeed(task_index);
+            if (accelerator_available and accelerator_speed > 0.0 and
+                canStartTask(task_index, this->accelerator_compute_service)) {
+                double accelerator_energy = estimateTaskEnergy(task_index, this->accelerator_compute_service, accelerator_speed);
+                double cpu_energy = target_cs ? estimateTaskEnergy(task_index, target_cs, this->power_profile_map[target_cs].speed, target_host) : 0.0;
+                if (not target_cs or accelerator_energy < cpu_energy) {
+                    WRENCH_INFO("Task %s is expected to use %.2lf J on an accelerator vs %.2lf J on a CPU core",
+                                task->getID().c_str(), accelerator_energy, cpu_energy);
+                    target_cs = this->accelerator_compute_service;
+                    target_host.clear();
+                }
+            }
+
+            if (not target_cs) {
+                // Remaining tasks may still be eligible for a free accelerator slot, or short enough to backfill
+                // the pilot job before it expires
+                bool idle_cores = std::any_of(compute_services.begin(), compute_services.end(),
+                                              [this](const std::shared_ptr<BareMetalComputeService> &cs) {
+                                                  return this->core_utilization_map[cs] > 0;
+                                              });
+                if (idle_cores) {
+                    continue;
+                }
+                break;
+            }
+
+            // A task that goes to a pilot job node that is powered down or booting waits for it (in the ready tasks)
+            if (not target_host.empty() and this->powered_down_hosts.count(target_host)) {
+                wakeUpPilotHost(target_host);
+            }
+            if (not target_host.empty() and this->booting_hosts.count(target_host)) {
+                num_cores_waiting_for_boot += num_cores;
+                continue;
+            }
+
+            if (not submitTask(task, target_cs, job_manager, num_cores, target_host)) {
+                break;
+            }
+            num_tasks_scheduled++;
+            if (this->consolidate_placement and target_cs != this->accelerator_compute_service) {
+                this->metrics["placement_estimated_energy"] += target_cost;
+                this->metrics["first_fit_estimated_energy"] += first_fit_energy;
+            }
+        }
+        WRENCH_INFO("Was able to schedule %lu out of %zu ready tasks", num_tasks_scheduled, ready_tasks.size());
+    }
+
+    /**
+     * @brief Submit a task to a compute service
+     *
+     * @param task: a ready task
+     * @param target_cs: a compute service with enough idle cores
+     * @param job_manager: a job manager
+     * @param num_cores: the number of cores to run the task on (no fewer than its minimum)
+     * @param hostname: the host of the compute service to pin the task to (by default, the service picks one)
+     * @return false if the task could not be submitted
+     */
+    bool SimpleWMS::submitTask(const std::shared_ptr<WorkflowTask> &task,
+                               const std::shared_ptr<BareMetalComputeService> &target_cs,
+                               const std::shared_ptr<JobManager> &job_manager,
+                               unsigned long num_cores,
+                               const std::string &hostname) {
+        auto task_index = this->task_graph_store->getTaskIndex(task);
+        // The co-location slowdown is set when the task starts, from the tasks already running on the node,
+        // and so is the wake-up latency of the socket the task wakes up, if any
+        double slowdown = predictSlowdown(task_index, target_cs);
+        auto category = this->task_graph_store->task_categories[task_index];
+        double speed = this->power_profile_map[target_cs].speed;
+        // On an accelerator slot, the task runs at the speedup of its category over a CPU core rather than at the
+        // host speed: its parallel efficiency is lowered accordingly
+        double efficiency = 1.0;
+        if (target_cs == this->accelerator_compute_service and getAcceleratorSpeed(task_index) > 0.0) {
+            efficiency = getAcceleratorSpeed(task_index) / speed;
+            speed = getAcceleratorSpeed(task_index);
+        }
+        // The task computes on all its cores at once
+        double compute_time = this->runtime_predictor.predictComputeTime(category, this->task_graph_store->task_flops[task_index],
+                                                                         speed * (double) num_cores);
+        efficiency /= slowdown;
+        // The wake-up latency is a fixed delay: the efficiency is lowered so that the simulated computation of
+        // the task (its flops on its cores) lasts that much longer
+        double wake_up_latency = predictWakeUpLatency(target_cs);
+        double simulated_time = task->getFlops() / ((double) num_cores * efficiency * this->power_profile_map[target_cs].speed);
+        if (wake_up_latency > 0.0 and simulated_time > 0.0) {
+            efficiency *= simulated_time / (simulated_time + wake_up_latency);
+        }
+        if (efficiency != 1.0 or this->task_predictions[task_index].efficiency != 1.0) {
+            task->setParallelModel(ParallelModel::CONSTANTEFFICIENCY(efficiency));
+        }
+        try {
+            auto job = job_manager->createStandardJob(task, getFileLocations(task_index));
+            WRENCH_INFO(
+                    "Submitting task %s to compute service %s", task->getID().c_str(),
+                    target_cs->getName().c_str());
+            {
+                SimulationProfiler::SimulationScope simulation_scope(this->profiler.get());
+                auto cores = std::to_string(num_cores);
+                job_manager->submitJob(job, target_cs, {{task->getID(), hostname.empty() ? cores : hostname + ":" + cores}});
+            }
+        } catch (ExecutionException &e) {
+            WRENCH_INFO("WARNING: Was not able to submit task %s, likely due to the pilot job having expired "
+                        "(I should get a notification of its expiration soon)",
+                        task->getID().c_str());
+            return false;
+        }
+        this->core_utilization_map[target_cs] -= num_cores;
+        recordDecision("task", task->getID(), target_cs->getName());
+        if (this->timeline_recorder) {
+            this->timeline_recorder->taskSubmitted(task_index, Simulation::getCurrentSimulatedDate());
+        }
+        if (wake_up_latency > 0.0) {
+            this->metrics["cstate_wakeups"]++;
+            this->metrics["cstate_wakeup_time"] += wake_up_latency;
+        }
+        this->task_predictions[task_index] = {speed * (double) num_cores,
+                                              slowdown * compute_time,
+                                              this->runtime_predictor.predictIOTime(category, this->task_graph_store->task_input_bytes[task_index] +
+                                                                                                      this->task_graph_store->task_output_bytes[task_index]),
+                                              slowdown,
+                                              efficiency,
+                                              wake_up_latency};
+        this->task_predictions[task_index].num_cores = num_cores;
+        if (not hostname.empty()) {
+            this->task_predictions[task_index].hostname = hostname;
+            this->pilot_host_busy_cores[hostname] += num_cores;
+        }
+        // The DVFS policy compares the energy to completion of the tasks of a host in each pstate
+        auto physical_hosts = this->physical_hosts_map.find(target_cs);
+        if (target_cs != this->accelerator_compute_service and physical_hosts != this->physical_hosts_map.end() and
+            (not hostname.empty() or physical_hosts->second.size() == 1)) {
+            auto &prediction = this->task_predictions[task_index];
+            prediction.physical_host = hostname.empty() ? physical_hosts->second.begin()->first : hostname;
+            prediction.remaining_work = prediction.compute_time * speed;
+            prediction.progress_date = Simulation::getCurrentSimulatedDate();
+            this->host_running_tasks[prediction.physical_host].insert(task_index);
+        }
+        if (this->interference_model and target_cs != this->accelerator_compute_service) {
+            this->memory_pressure_map[target_cs] += this->interference_model->getIntensity(category) * (double) num_cores;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Get the compute service slots of the external scheduling policy and of the schedule plan:
+     *        the VMs, the pilot job and the accelerator service (if any), in this order, so that a slot
+     *        always designates the same service (slots whose service is not available are null)
+     *
+     * @param compute_services: the compute services currently available
+     * @return the compute service of each slot
+     */
+    std::vector<std::shared_ptr<BareMetalComputeService>> SimpleWMS::getServiceSlots(
+            const std::set<std::shared_ptr<BareMetalComputeService>> &compute_services) const {
+        auto slots = this->vm_compute_services;
+        slots.push_back(this->pilot_job_is_running ? this->pilot_job->getComputeService() : nullptr);
+        if (this->accelerator_compute_service) {
+            slots.push_back(this->accelerator_compute_service);
+        }
+        for (auto &slot: slots) {
+            if (slot and compute_services.find(slot) == compute_services.end()) {
+                slot = nullptr;
+            }
+        }
+        return slots;
+    }
+
+    /**
+     * @brief Build what the external scheduling policy observes
+     *
+     * @param ready_tasks: the ready tasks to schedule
+     * @param slots: the compute service slots
+     * @return an observation
+     */
+    PolicyObservation SimpleWMS::observePolicyState(const std::vector<std::shared_ptr<WorkflowTask>> &ready_tasks,
+                                                    const std::vector<std::shared_ptr<BareMetalComputeService>> &slots) {
+        auto const &store = this->task_graph_store;
+        PolicyObservation observation;
+        observation.date = Simulation::getCurrentSimulatedDate();
+        auto hostnames = Simulation::getHostnameList();
+        for (auto const &energy: this->simulation_->getEnergyConsumed(hostnames)) {
+            observation.energy += energy.second;
+        }
+
+        for (auto const &task: ready_tasks) {
+            auto task_index = store->getTaskIndex(task);
+            observation.task_predicted_runtimes.push_back(predictTaskRuntime(task_index, this->cpu_reference_speed));
+            observation.task_flops.push_back(store->task_flops[task_index]);
+            observation.task_io_bytes.push_back(store->task_input_bytes[task_index] + store->task_output_bytes[task_index]);
+            observation.task_categories.push_back(store->task_categories[task_index]);
+            observation.task_num_children.push_back((double) (store->child_offsets[task_index + 1] - store->child_offsets[task_index]));
+            observation.task_indices.push_back(task_index);
+        }
+
+        for (auto const &cs: slots) {
+            auto profile = cs ? this->power_profile_map[cs] : HostPowerProfile();
+            observation.service_idle_cores.push_back(cs ? (double) this->core_utilization_map[cs] : 0.0);
+            observation.service_total_cores.push_back(cs ? (double) this->total_cores_map[cs] : 0.0);
+            observation.service_speeds.push_back(cs ? profile.speed : 0.0);
+            observation.service_idle_watts.push_back(profile.idle_watts);
+            observation.service_all_cores_watts.push_back(profile.all_cores_watts);
+            observation.service_accelerators.push_back(cs and cs == this->accelerator_compute_service ? 1.0 : 0.0);
+        }
+
+        for (auto const &hostname: hostnames) {
+            observation.host_pstates.push_back((double) Simulation::getCurrentPstate(hostname));
+            observation.host_powered_down.push_back(this->powered_down_hosts.count(hostname) ? 1.0 : 0.0);
+        }
+        return observation;
+    }
+
+    /**
+     * @brief Schedule the ready tasks as decided by the external scheduling policy. Actions that designate
+     *        an unavailable slot, a slot without enough idle cores for the task, the accelerator slot for a
+     *        task category it does not run, or the pilot job for a task predicted to outlast it, leave the task
+     *        ready (as invalid actions), so that the policy cannot place tasks where the WMS would not. If the
+     *        policy defers all the tasks while no task is running, the WMS would wait forever, so its own
+     *        placement is used for that round instead.
+     *
+     * @param ready_tasks: the ready tasks to schedule
+     * @param job_manager: a job manager
+     * @param compute_services: the compute services currently available
+     * @return false if the tasks are to be scheduled by the WMS itself
+     */
+    bool SimpleWMS::scheduleTasksWithPolicy(const std::vector<std::shared_ptr<WorkflowTask>> &ready_tasks,
+                                            const std::shared_ptr<JobManager> &job_manager,
+                                            const std::set<std::shared_ptr<BareMetalComputeService>> &compute_services) {
+        auto slots = getServiceSlots(compute_services);
+        // There is nothing to decide while all the cores are busy
+        if (std::none_of(slots.begin(), slots.end(), [this](const std::shared_ptr<BareMetalComputeService> &cs) {
+                return cs and this->core_utilization_map[cs] > 0;
+            })) {
+            return true;
+        }
+        auto actions = this->policy_channel->decide(observePolicyState(ready_tasks, slots));
+        this->metrics["policy_decisions"]++;
+
+        unsigned long num_tasks_scheduled = 0;
+        for (unsigned long i = 0; i < ready_tasks.size(); i++) {
+            if (actions[i] < 0) {
+                continue;
+            }
+            auto task_index = this->task_graph_store->getTaskIndex(ready_tasks[i]);
+            if ((size_t) actions[i] >= slots.size() or not slots[actions[i]] or not canStartTask(task_index, slots[actions[i]])) {
+                this->metrics["policy_invalid_actions"]++;
+                continue;
+            }
+            if ((slots[actions[i]] == this->accelerator_compute_service and
+                 this->accelerator_speedups[this->task_graph_store->task_categories[task_index]] <= 0.0) or
+                exceedsPilotJobWalltime(task_index, slots[actions[i]])) {
+                this->metrics["policy_invalid_actions"]++;
+                continue;
+            }
+            if (submitTask(ready_tasks[i], slots[actions[i]], job_manager, this->task_graph_store->task_min_cores[task_index])) {
+                num_tasks_scheduled++;
+            }
+        }
+
+        bool tasks_running = false;
+        for (auto const &cs: this->core_utilization_map) {
+            tasks_running = tasks_running or cs.second < this->total_cores_map[cs.first];
+        }
+        if (num_tasks_scheduled == 0 and not tasks_running) {
+            this->metrics["policy_fallbacks"]++;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Submit the tasks of the schedule plan that can start: on each slot, the next tasks in the plan
+     *        order, as long as they are ready and the slot has enough idle cores (a task that is not ready
+     *        yet holds back the tasks planned after it on its slot)
+     *
+     * @param job_manager: a job manager
+     * @param compute_services: the compute services currently available
+     */
+    void SimpleWMS::scheduleTasksWithPlan(const std::shared_ptr<JobManager> &job_manager,
+                                          const std::set<std::shared_ptr<BareMetalComputeService>> &compute_services) {
+        auto slots = getServiceSlots(compute_services);
+        auto const &planned_tasks = this->schedule_plan->getPlannedTasks();
+        for (unsigned long slot = 0; slot < slots.size(); slot++) {
+            auto const &cs = slots[slot];
+            auto &queue = this->plan_slot_queues[slot];
+            while (cs and not queue.empty()) {
+                auto task_index = queue.begin()->second;
+                auto const &task = this->task_graph_store->tasks[task_index];
+                auto const &planned_task = planned_tasks[task_index];
+                if (task->getState() != WorkflowTask::State::READY or this->core_utilization_map[cs] < planned_task.num_cores) {
+                    break;
+                }
+                // The hosts of the slot run in the planned pstate (the pstates of the accelerator nodes are not managed)
+                auto physical_hosts = this->physical_hosts_map.find(cs);
+                if (physical_hosts != this->physical_hosts_map.end()) {
+                    for (auto const &host: physical_hosts->second) {
+                        auto &profiles = this->host_pstate_profiles[host.first];
+                        if (profiles.empty()) {
+                            profiles = HostPowerProfile::getPstateProfiles(host.first);
+                        }
+                        if (planned_task.pstate < profiles.size() and (long) planned_task.pstate != HostPowerProfile::getSleepPstate(host.first) and
+                            planned_task.pstate != (unsigned long) Simulation::getCurrentPstate(host.first)) {
+                            this->simulation_->setPstate(host.first, planned_task.pstate);
+                            recordDecision("pstate", host.first, std::to_string(planned_task.pstate));
+                        }
                     }
+                    this->power_profile_map[cs] = this->host_pstate_profiles[physical_hosts->second.begin()->first]
+                                                          [Simulation::getCurrentPstate(physical_hosts->second.begin()->first)];
+                }
+                if (not submitTask(task, cs, job_manager, planned_task.num_cores)) {
                     break;
                 }
+                queue.erase(queue.begin());
             }
-            if (not scheduled) break;
         }
-        WRENCH_INFO("Was able to schedule %lu out of %zu ready tasks", num_tasks_scheduled, ready_tasks.size());
+    }
+
+    /**
+     * @brief Compare the execution of a task with the schedule plan
+     *
+     * @param task_index: the index of a completed task
+     * @param start_date: the date at which the task started
+     * @param end_date: the date at which the task completed
+     * @param pstate: the pstate of the host the task ran on, at completion
+     */
+    void SimpleWMS::recordPlanDeviation(unsigned long task_index, double start_date, double end_date, unsigned long pstate) {
+        auto const &planned_task = this->schedule_plan->getPlannedTasks()[task_index];
+        PlanDeviation deviation = {task_index, planned_task.planned_start, start_date, planned_task.planned_end, end_date,
+                                   planned_task.pstate, pstate};
+        this->plan_deviations.push_back(deviation);
+        double start_delay = start_date - planned_task.planned_start;
+        this->metrics["plan_tasks_completed"]++;
+        this->metrics["plan_total_start_delay"] += start_delay;
+        this->metrics["plan_max_start_delay"] = std::max(this->metrics["plan_max_start_delay"], start_delay);
+        this->metrics["plan_total_end_delay"] += end_date - planned_task.planned_end;
+        this->metrics["plan_planned_makespan"] = std::max(this->metrics["plan_planned_makespan"], planned_task.planned_end);
+        if (pstate != planned_task.pstate) {
+            this->metrics["plan_pstate_deviations"]++;
+        }
+    }
+
+    /**
+     * @brief Set the pstate of the physical hosts of the CPU compute services according to the DVFS policy
+     *
+     * @param compute_services: the compute services currently available
+     * @param saturated: whether ready tasks are waiting for a core
+     */
+    void SimpleWMS::applyDvfsPolicy(const std::set<std::shared_ptr<BareMetalComputeService>> &compute_services,
+                                    bool saturated) {
+        for (auto const &cs: compute_services) {
+            auto physical_hosts = this->physical_hosts_map.find(cs);
+            if (cs == this->accelerator_compute_service or physical_hosts == this->physical_hosts_map.end()) {
+                continue;
+            }
+            // The WMS knows the load of single-host services; multi-host ones (the pilot job) are asked
+            std::map<std::string, unsigned long> per_host_busy_cores;
+            if (physical_hosts->second.size() == 1) {
+                per_host_busy_cores[physical_hosts->second.begin()->first] = this->total_cores_map[cs] - this->core_utilization_map[cs];
+            } else {
+                for (auto const &idle_cores: cs->getPerHostNumIdleCores()) {
+                    per_host_busy_cores[idle_cores.first] = physical_hosts->second[idle_cores.first] - idle_cores.second;
+                }
+            }
+            for (auto const &busy_cores: per_host_busy_cores) {
+                // Powered-down nodes stay so until the WMS wakes them up
+                if (this->powered_down_hosts.count(busy_cores.first)) {
+                    continue;
+                }
+                auto pstate = selectPstate(busy_cores.first, busy_cores.second, saturated);
+                if (pstate != (unsigned long) Simulation::getCurrentPstate(busy_cores.first)) {
+                    updateTaskProgress(busy_cores.first);
+                    this->simulation_->setPstate(busy_cores.first, pstate);
+                    this->metrics["dvfs_pstate_changes"]++;
+                    recordDecision("pstate", busy_cores.first, std::to_string(pstate));
+                }
+            }
+            auto hostname = physical_hosts->second.begin()->first;
+            for (auto const &host: physical_hosts->second) {
+                if (not this->powered_down_hosts.count(host.first)) {
+                    hostname = host.first;
+                    break;
+                }
+            }
+            this->power_profile_map[cs] = this->host_pstate_profiles[hostname][Simulation::getCurrentPstate(hostname)];
+        }
+    }
+
+    /**
+     * @brief Select the pstate of a host according to the DVFS policy
+     *
+     * @param hostname: the name of a physical host
+     * @param busy_cores: the number of busy cores of the host
+     * @param saturated: whether ready tasks are waiting for a core
+     * @return a pstate
+     */
+    unsigned long SimpleWMS::selectPstate(const std::string &hostname, unsigned long busy_cores, bool saturated) {
+        auto &profiles = this->host_pstate_profiles[hostname];
+        if (profiles.empty()) {
+            profiles = HostPowerProfile::getPstateProfiles(hostname);
+        }
+        // The pstate that models a powered-down host is not a DVFS level, and the turbo pstate is only
+        // available while few cores are busy
+        long sleep_pstate = HostPowerProfile::getSleepPstate(hostname);
+        long turbo_pstate = HostPowerProfile::getTurboPstate(hostname);
+        bool turbo_available = busy_cores > 0 and busy_cores <= HostPowerProfile::getTurboMaxCores(hostname);
+        auto excluded = [sleep_pstate, turbo_pstate, turbo_available](unsigned long pstate) {
+            return (long) pstate == sleep_pstate or ((long) pstate == turbo_pstate and not turbo_available);
+        };
+        unsigned long first = 0;
+        while (first + 1 < profiles.size() and excluded(first)) {
+            first++;
+        }
+        if (this->dvfs_policy == "powersave") {
+            unsigned long slowest = first;
+            for (unsigned long pstate = first + 1; pstate < profiles.size(); pstate++) {
+                if (not excluded(pstate) and profiles[pstate].speed < profiles[slowest].speed) {
+                    slowest = pstate;
+                }
+            }
+            return slowest;
+        }
+        // "performance" always races; "energy": the backlog is cleared as fast as possible; otherwise idle
+        // hosts draw the lowest idle power and busy hosts compute with the lowest energy per flop at their
+        // load (ties favor speed)
+        unsigned long fastest = first;
+        for (unsigned long pstate = first + 1; pstate < profiles.size(); pstate++) {
+            if (not excluded(pstate) and profiles[pstate].speed > profiles[fastest].speed) {
+                fastest = pstate;
+            }
+        }
+        if (this->dvfs_policy == "performance" or saturated) {
+            return fastest;
+        }
+        // When the WMS knows the remaining work of all the tasks of a busy host, the pstates are compared by
+        // the energy until the last task completes, plus the lowest idle power until it would complete in the
+        // slowest pstate (so that racing to idle is rewarded as the host empties)
+        auto remaining_work = getRemainingWork(hostname);
+        unsigned long known_cores = 0;
+        for (auto const &work: remaining_work) {
+            known_cores += work.second;
+        }
+        if (busy_cores > 0 and known_cores == busy_cores and remaining_work.back().first > 0.0) {
+            double slowest_speed = profiles[fastest].speed;
+            double idle_power = profiles[fastest].getPower(0.0, this->consolidate_sockets);
+            for (unsigned long pstate = 0; pstate < profiles.size(); pstate++) {
+                if (not excluded(pstate)) {
+                    slowest_speed = std::min(slowest_speed, profiles[pstate].speed);
+                    idle_power = std::min(idle_power, profiles[pstate].getPower(0.0, this->consolidate_sockets));
+                }
+            }
+            double horizon = remaining_work.back().first / slowest_speed;
+            unsigned long best = fastest;
+            double best_energy = predictEnergyToCompletion(profiles[fastest], this->consolidate_sockets, remaining_work, horizon, idle_power);
+            for (unsigned long pstate = 0; pstate < profiles.size(); pstate++) {
+                if (excluded(pstate)) {
+                    continue;
+                }
+                double energy = predictEnergyToCompletion(profiles[pstate], this->consolidate_sockets, remaining_work, horizon, idle_power);
+                if (energy < best_energy * (1.0 - 1e-9)) {
+                    best = pstate;
+                    best_energy = energy;
+                }
+            }
+            return best;
+        }
+        unsigned long best = fastest;
+        for (unsigned long pstate = 0; pstate < profiles.size(); pstate++) {
+            if (excluded(pstate)) {
+                continue;
+            }
+            double cost = busy_cores ? profiles[pstate].getEnergyPerFlop(busy_cores, this->consolidate_sockets)
+                                     : profiles[pstate].getPower(0.0, this->consolidate_sockets);
+            double best_cost = busy_cores ? profiles[best].getEnergyPerFlop(busy_cores, this->consolidate_sockets)
+                                          : profiles[best].getPower(0.0, this->consolidate_sockets);
+            if (cost < best_cost * (1.0 - 1e-9)) {
+                best = pstate;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * @brief Get the predicted computation left of the running tasks of a physical host
+     *
+     * @param hostname: the name of a physical host
+     * @return the work left of each task (in seconds at a core speed of 1 flop/sec) and its number of cores,
+     *         in increasing order of work
+     */
+    std::vector<std::pair<double, unsigned long>> SimpleWMS::getRemainingWork(const std::string &hostname) const {
+        std::vector<std::pair<double, unsigned long>> remaining_work;
+        auto running_tasks = this->host_running_tasks.find(hostname);
+        auto profiles = this->host_pstate_profiles.find(hostname);
+        if (running_tasks == this->host_running_tasks.end() or profiles == this->host_pstate_profiles.end()) {
+            return remaining_work;
+        }
+        double speed = profiles->second[Simulation::getCurrentPstate(hostname)].speed;
+        double now = Simulation::getCurrentSimulatedDate();
+        for (auto task_index: running_tasks->second) {
+            auto const &prediction = this->task_predictions[task_index];
+            // A task that overruns its prediction is assumed to be about to complete
+            remaining_work.emplace_back(std::max(0.0, prediction.remaining_work - (now - prediction.progress_date) * speed),
+                                        prediction.num_cores);
+        }
+        std::sort(remaining_work.begin(), remaining_work.end());
+        return remaining_work;
+    }
+
+    /**
+     * @brief Predict the energy of a host until a date if it stays in a pstate: its tasks complete one after
+     *        the other, each lowering the power of the host, and it then draws the given idle power
+     *
+     * @param profile: the power profile of the host in the pstate
+     * @param consolidated: whether the busy cores are consolidated onto as few sockets as possible
+     * @param remaining_work: the work left of the tasks of the host and their number of cores, in increasing order of work
+     * @param horizon: the date until which the energy is predicted (no earlier than the completion of the tasks)
+     * @param idle_power: the power of the host once its tasks have completed, in Watts
+     * @return an energy in Joules
+     */
+    double SimpleWMS::predictEnergyToCompletion(const HostPowerProfile &profile, bool consolidated,
+                                                const std::vector<std::pair<double, unsigned long>> &remaining_work,
+                                                double horizon, double idle_power) {
+        double busy_cores = 0.0;
+        for (auto const &work: remaining_work) {
+            busy_cores += (double) work.second;
+        }
+        double energy = 0.0;
+        double date = 0.0;
+        for (auto const &work: remaining_work) {
+            double end_date = work.first / profile.speed;
+            energy += profile.getPower(busy_cores, consolidated) * (end_date - date);
+            busy_cores -= (double) work.second;
+            date = end_date;
+        }
+        return energy + idle_power * std::max(0.0, horizon - date);
+    }
+
+    /**
+     * @brief Account for the computation done by the running tasks of a physical host in its current pstate,
+     *        before the pstate changes
+     *
+     * @param hostname: the name of a physical host
+     */
+    void SimpleWMS::updateTaskProgress(const std::string &hostname) {
+        auto running_tasks = this->host_running_tasks.find(hostname);
+        if (running_tasks == this->host_running_tasks.end()) {
+            return;
+        }
+        double speed = this->host_pstate_profiles[hostname][Simulation::getCurrentPstate(hostname)].speed;
+        double now = Simulation::getCurrentSimulatedDate();
+        for (auto task_index: running_tasks->second) {
+            auto &prediction = this->task_predictions[task_index];
+            prediction.remaining_work = std::max(0.0, prediction.remaining_work - (now - prediction.progress_date) * speed);
+            prediction.progress_date = now;
+        }
+    }
+
+    /**
+     * @brief Forget a task that has completed or failed on the physical host it was running on
+     *
+     * @param task_index: the index of a workflow task
+     */
+    void SimpleWMS::removeRunningTask(unsigned long task_index) {
+        auto &prediction = this->task_predictions[task_index];
+        if (not prediction.physical_host.empty()) {
+            this->host_running_tasks[prediction.physical_host].erase(task_index);
+            prediction.physical_host.clear();
+        }
+    }
+
+    /**
+     * @brief Estimate the energy a task adds to the hosts of a compute service if it runs on one of
+     *        its idle cores, i.e., the marginal power of that core times the task runtime (co-location
+     *        slowdown included)
+     *
+     * @param task_index: the index of a workflow task
+     * @param cs: a compute service with at least one idle core
+     * @param speed: the speed at which the task would compute, in flop/sec
+     * @param hostname: the pilot job node the task would be pinned to (by default, the hosts of a multi-host
+     *        service are assumed to fill one after the other); a node that is powered down adds its idle
+     *        power during its boot and the task runtime
+     * @return an energy in Joules
+     */
+    double SimpleWMS::estimateTaskEnergy(unsigned long task_index,
+                                         const std::shared_ptr<BareMetalComputeService> &cs,
+                                         double speed,
+                                         const std::string &hostname) {
+        auto const &profile = this->power_profile_map[cs];
+        double num_cores = (double) this->task_graph_store->task_min_cores[task_index];
+        double runtime = predictSlowdown(task_index, cs) * this->task_graph_store->task_flops[task_index] / (speed * num_cores);
+        if (hostname.empty()) {
+            auto busy_cores = (this->total_cores_map[cs] - this->core_utilization_map[cs]) % profile.num_cores;
+            return profile.getMarginalPower(busy_cores, num_cores, this->consolidate_sockets) * runtime;
+        }
+        double energy = profile.getMarginalPower(this->pilot_host_busy_cores[hostname], num_cores, this->consolidate_sockets) * runtime;
+        if (this->powered_down_hosts.count(hostname)) {
+            energy += profile.idle_watts * (HostPowerProfile::getBootTime(hostname) + runtime);
+        }
+        return energy;
+    }
+
+    /**
+     * @brief Select the pilot job node a task goes to with consolidated placement: the awake node with enough
+     *        idle cores that runs the most tasks, or else a booting node whose cores are not all awaited yet,
+     *        or else a powered-down node (to be woken up)
+     *
+     * @param cs: the compute service of the pilot job
+     * @param num_cores: the number of cores of the task
+     * @param num_cores_waiting_for_boot: the number of cores of the tasks already waiting for the booting nodes
+     * @return a node name, or an empty string if the task has to wait for the booting nodes anyway
+     */
+    std::string SimpleWMS::selectPilotHost(const std::shared_ptr<BareMetalComputeService> &cs,
+                                           unsigned long num_cores,
+                                           unsigned long num_cores_waiting_for_boot) const {
+        std::string busiest_host, booting_host, powered_down_host;
+        unsigned long busiest_host_cores = 0;
+        unsigned long booting_cores = 0;
+        for (auto const &host: this->physical_hosts_map.at(cs)) {
+            auto busy_cores = this->pilot_host_busy_cores.find(host.first);
+            unsigned long num_busy_cores = busy_cores == this->pilot_host_busy_cores.end() ? 0 : busy_cores->second;
+            if (host.second < num_cores) {
+                continue;
+            }
+            if (this->booting_hosts.count(host.first)) {
+                booting_host = host.first;
+                booting_cores += host.second;
+            } else if (this->powered_down_hosts.count(host.first)) {
+                if (powered_down_host.empty()) {
+                    powered_down_host = host.first;
+                }
+            } else if (num_busy_cores + num_cores <= host.second and (busiest_host.empty() or num_busy_cores > busiest_host_cores)) {
+                busiest_host = host.first;
+                busiest_host_cores = num_busy_cores;
+            }
+        }
+        if (not busiest_host.empty()) {
+            return busiest_host;
+        }
+        return num_cores_waiting_for_boot + num_cores <= booting_cores ? booting_host : powered_down_host;
+    }
+
+    /**
+     * @brief Wake up a powered-down pilot job node for consolidated placement (the tasks that go to it wait
+     *        until it has booted)
+     *
+     * @param hostname: the name of a pilot job node
+     */
+    void SimpleWMS::wakeUpPilotHost(const std::string &hostname) {
+        double boot_time = powerUpBatchHosts({hostname});
+        this->metrics["pilot_node_wake_ups"]++;
+        if (boot_time > 0.0) {
+            WRENCH_INFO("Waking up pilot job node %s (%.0lf seconds to boot)", hostname.c_str(), boot_time);
+            this->booting_hosts.insert(hostname);
+            this->setTimer(Simulation::getCurrentSimulatedDate() + boot_time,
+                           "pilot_node_booted:" + std::to_string(this->num_pilot_jobs) + ":" + hostname);
+        }
+    }
+
+    /**
+     * @brief Power down the pilot job nodes that have run no task for their power-down delay, with consolidated
+     *        placement (a timer wakes the WMS up when the delay of a node that just became idle expires)
+     */
+    void SimpleWMS::powerDownIdlePilotHosts() {
+        auto pilot_cs = this->pilot_job->getComputeService();
+        auto const &pilot_hosts = this->physical_hosts_map[pilot_cs];
+        bool idle_hosts = std::any_of(pilot_hosts.begin(), pilot_hosts.end(), [this](const std::pair<const std::string, unsigned long> &host) {
+            return this->pilot_host_busy_cores[host.first] == 0 and not this->booting_hosts.count(host.first) and
+                   not this->powered_down_hosts.count(host.first);
+        });
+        if (not idle_hosts) {
+            this->pilot_host_idle_since.clear();
+            return;
+        }
+        // The service is asked as well, in case tasks it runs were not pinned to their node
+        double now = Simulation::getCurrentSimulatedDate();
+        std::vector<std::string> hostnames;
+        for (auto const &idle_cores: pilot_cs->getPerHostNumIdleCores()) {
+            auto const &hostname = idle_cores.first;
+            if (idle_cores.second != pilot_hosts.at(hostname) or this->pilot_host_busy_cores[hostname] != 0 or
+                this->booting_hosts.count(hostname) or this->powered_down_hosts.count(hostname)) {
+                this->pilot_host_idle_since.erase(hostname);
+                continue;
+            }
+            double delay = getPowerDownDelay(hostname);
+            auto idle_since = this->pilot_host_idle_since.find(hostname);
+            if (idle_since == this->pilot_host_idle_since.end()) {
+                this->pilot_host_idle_since[hostname] = now;
+                if (delay > 0.0 and delay < std::numeric_limits<double>::infinity()) {
+                    this->setTimer(now + delay, "pilot_node_idle:" + std::to_string(this->num_pilot_jobs) + ":" + hostname);
+                }
+                if (delay > 0.0) {
+                    continue;
+                }
+            } else if (now - idle_since->second < delay) {
+                continue;
+            }
+            hostnames.push_back(hostname);
+            this->pilot_host_idle_since.erase(hostname);
+        }
+        auto num_powered_down_hosts = this->powered_down_hosts.size();
+        powerDownBatchHosts(hostnames);
+        this->metrics["pilot_node_power_downs"] += (double) (this->powered_down_hosts.size() - num_powered_down_hosts);
+    }
+
+    /**
+     * @brief Get how long an idle pilot job node stays up before it is powered down: the configured delay, or
+     *        else its break-even time boot_time * idle_power / (idle_power - sleep_power), i.e., the idle time
+     *        whose energy savings in the sleep pstate pay for a boot at the idle power (waiting that long before
+     *        powering down costs at most twice the energy of the best decision in hindsight)
+     *
+     * @param hostname: the name of a pilot job node
+     * @return a time in seconds (infinite if the node saves no power asleep)
+     */
+    double SimpleWMS::getPowerDownDelay(const std::string &hostname) const {
+        if (this->power_down_delay >= 0.0) {
+            return this->power_down_delay;
+        }
+        auto sleep_pstate = HostPowerProfile::getSleepPstate(hostname);
+        if (sleep_pstate < 0) {
+            return 0.0;
+        }
+        double idle_power = HostPowerProfile::fromHost(hostname, 0).idle_watts;
+        double sleep_power = HostPowerProfile::fromHost(hostname, sleep_pstate).idle_watts;
+        if (idle_power <= sleep_power) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return HostPowerProfile::getBootTime(hostname) * idle_power / (idle_power - sleep_power);
+    }
+
+    /**
+     * @brief Predict the time a task that started now on a compute service would wait for its socket to
+     *        leave its deep idle state, i.e., if no core of that socket is busy (with consolidated sockets,
+     *        the tasks of a host fill its sockets one after the other; otherwise, one per socket first)
+     *
+     * @param cs: a compute service with at least one idle core
+     * @return a time in seconds
+     */
+    double SimpleWMS::predictWakeUpLatency(const std::shared_ptr<BareMetalComputeService> &cs) {
+        auto physical_hosts = this->physical_hosts_map.find(cs);
+        if (physical_hosts == this->physical_hosts_map.end()) {
+            return 0.0;
+        }
+        auto const &hostname = physical_hosts->second.begin()->first;
+        double latency = HostPowerProfile::getWakeUpLatency(hostname);
+        if (latency <= 0.0) {
+            return 0.0;
+        }
+        // The tasks of a multi-host service (the pilot job) are assumed to fill its hosts one after the other
+        auto const &profile = this->power_profile_map[cs];
+        auto busy_cores = (this->total_cores_map[cs] - this->core_utilization_map[cs]) % profile.num_cores;
+        auto socket_cores = profile.num_cores / profile.num_sockets;
+        bool wakes_socket = this->consolidate_sockets ? busy_cores % socket_cores == 0 : busy_cores < profile.num_sockets;
+        return wakes_socket ? latency : 0.0;
+    }
+
+    /**
+     * @brief Predict the co-location slowdown of a task if it started now on a compute service
+     *
+     * @param task_index: the index of a workflow task
+     * @param cs: a compute service
+     * @return a factor (>= 1) by which the compute time of the task would be multiplied
+     */
+    double SimpleWMS::predictSlowdown(unsigned long task_index, const std::shared_ptr<BareMetalComputeService> &cs) {
+        auto physical_hosts = this->physical_hosts_map.find(cs);
+        if (not this->interference_model or physical_hosts == this->physical_hosts_map.end()) {
+            return 1.0;
+        }
+        // The tasks of a multi-host service (the pilot job) are assumed to be spread evenly over its hosts
+        double num_hosts = (double) physical_hosts->second.size();
+        return this->interference_model->getSlowdown(this->task_graph_store->task_categories[task_index],
+                                                     this->memory_pressure_map[cs] / num_hosts,
+                                                     physical_hosts->second.begin()->second);
+    }
+
+    /**
+     * @brief Get the speed at which a task runs on an accelerator slot: the speedup of its category over a
+     *        CPU core, capped at the speed of the accelerator host
+     *
+     * @param task_index: the index of a workflow task
+     * @return a speed in flop/sec (0 if the accelerator does not run the category of the task)
+     */
+    double SimpleWMS::getAcceleratorSpeed(unsigned long task_index) {
+        if (not this->accelerator_compute_service) {
+            return 0.0;
+        }
+        double speedup = this->accelerator_speedups[this->task_graph_store->task_categories[task_index]];
+        return (speedup > 0.0) ? std::min<double>(this->power_profile_map[this->accelerator_compute_service].speed,
+                                                  this->cpu_reference_speed * speedup)
+                               : 0.0;
+    }
+
+    /**
+     * @brief Whether a task can start now on a compute service: the service has as many idle cores as the
+     *        task needs, and one of its hosts has that many cores
+     *
+     * @param task_index: the index of a workflow task
+     * @param cs: a compute service
+     * @return true or false
+     */
+    bool SimpleWMS::canStartTask(unsigned long task_index, const std::shared_ptr<BareMetalComputeService> &cs) {
+        auto num_cores = this->task_graph_store->task_min_cores[task_index];
+        if (this->core_utilization_map[cs] < num_cores) {
+            return false;
+        }
+        auto physical_hosts = this->physical_hosts_map.find(cs);
+        if (physical_hosts == this->physical_hosts_map.end()) {
+            return this->power_profile_map[cs].num_cores >= num_cores;
+        }
+        return std::any_of(physical_hosts->second.begin(), physical_hosts->second.end(),
+                           [num_cores](const std::pair<const std::string, unsigned long> &host) { return host.second >= num_cores; });
+    }
+
+    /**
+     * @brief Whether a task that started now on a compute service would be predicted to run past the
+     *        expiration of the pilot job, if that service is the pilot job
+     *
+     * @param task_index: the index of a workflow task
+     * @param cs: a compute service
+     * @return true or false
+     */
+    bool SimpleWMS::exceedsPilotJobWalltime(unsigned long task_index, const std::shared_ptr<BareMetalComputeService> &cs) {
+        return this->pilot_job_is_running and cs == this->pilot_job->getComputeService() and
+               Simulation::getCurrentSimulatedDate() + predictTaskRuntime(task_index, this->power_profile_map[cs].speed) >
+                       this->pilot_job_start_date + this->pilot_job_walltime;
+    }
+
+    /**
+     * @brief Predict the runtime of a task (I/O included) on its cores with the online runtime predictor
+     *
+     * @param task_index: the index of a workflow task
+     * @param speed: the speed of the cores the task would run on, in flop/sec
+     * @return a time in seconds
+     */
+    double SimpleWMS::predictTaskRuntime(unsigned long task_index, double speed) const {
+        auto const &store = this->task_graph_store;
+        auto category = store->task_categories[task_index];
+        return this->runtime_predictor.predictComputeTime(category, store->task_flops[task_index],
+                                                          speed * (double) store->task_min_cores[task_index]) +
+               this->runtime_predictor.predictIOTime(category, store->task_input_bytes[task_index] + store->task_output_bytes[task_index]);
+    }
+
+    /**
+     * @brief Get the locations of the input and output files of a task, i.e., the one storage service
+     *
+     * @param task_index: the index of a workflow task
+     * @return a map of file locations
+     */
+    std::map<std::shared_ptr<DataFile>, std::shared_ptr<FileLocation>> SimpleWMS::getFileLocations(unsigned long task_index) const {
+        auto const &store = this->task_graph_store;
+        std::map<std::shared_ptr<DataFile>, std::shared_ptr<FileLocation>> locations;
+        for (auto i = store->input_offsets[task_index]; i < store->input_offsets[task_index + 1]; i++) {
+            locations[store->files[store->inputs[i]]] = this->file_locations[store->inputs[i]];
+        }
+        for (auto i = store->output_offsets[task_index]; i < store->output_offsets[task_index + 1]; i++) {
+            locations[store->files[store->outputs[i]]] = this->file_locations[store->outputs[i]];
+        }
+        return locations;
+    }
+
+    /**
+     * @brief Predict the walltime the pilot job needs to complete the remaining work: twice the predicted
+     *        remaining work divided by the pilot job cores, plus the time for its nodes to boot
+     *
+     * @param num_nodes: the number of nodes of the pilot job
+     * @return a walltime in seconds
+     */
+    double SimpleWMS::predictPilotJobWalltime(unsigned long num_nodes) const {
+        constexpr double default_walltime = 3600000;
+        constexpr double min_walltime = 600;
+        double boot_time = 0.0;
+        for (auto const &hostname: this->powered_down_hosts) {
+            boot_time = std::max(boot_time, HostPowerProfile::getBootTime(hostname));
+        }
+        if (this->runtime_predictor.getNumObservations() == 0) {
+            return default_walltime;
+        }
+        double remaining_work = 0.0;
+        for (unsigned long i = 0; i < this->task_graph_store->getNumTasks(); i++) {
+            if (this->task_graph_store->tasks[i]->getState() != WorkflowTask::State::COMPLETED) {
+                remaining_work += predictTaskRuntime(i, this->cpu_reference_speed) * (double) this->task_graph_store->task_min_cores[i];
+            }
+        }
+        double num_cores = (double) (num_nodes * this->batch_hosts.begin()->second);
+        return std::min(default_walltime, std::max(min_walltime, 2 * remaining_work / num_cores) + boot_time);
+    }
+
+    /**
+     * @brief Select the number of nodes of the next pilot job. When batch nodes can be powered down,
+     *        each node costs its boot energy plus its idle power for as long as the workflow runs, while
+     *        more nodes shorten the run (down to the remaining critical path) and thus the time the
+     *        hosts that are never powered down stay on. The energy of the computation depends on the
+     *        count as well: the remaining work is shared by the VMs and the pilot job nodes in proportion
+     *        to their cores, and each host computes at the power of its average number of busy cores,
+     *        so that spreading the work over more nodes pays their one-core power step more often. The
+     *        count that minimizes the sum of both is selected
+     *
+     * @return a number of nodes
+     */
+    unsigned long SimpleWMS::selectPilotJobNodeCount() const {
+        constexpr unsigned long default_num_nodes = 6;
+        if (this->powered_down_hosts.empty()) {
+            return default_num_nodes;
+        }
+        auto const &store = this->task_graph_store;
+
+        // Remaining work, in core-seconds, and critical path (longest chain of predicted runtimes among the remaining tasks)
+        std::vector<double> runtimes(store->getNumTasks(), 0.0);
+        std::vector<unsigned long> num_remaining_parents(store->getNumTasks(), 0);
+        std::vector<double> path_lengths(store->getNumTasks(), 0.0);
+        std::vector<unsigned long> ready;
+        double remaining_work = 0.0;
+        for (unsigned long i = 0; i < store->getNumTasks(); i++) {
+            if (store->tasks[i]->getState() == WorkflowTask::State::COMPLETED) {
+                continue;
+            }
+            runtimes[i] = predictTaskRuntime(i, this->cpu_reference_speed);
+            remaining_work += runtimes[i] * (double) store->task_min_cores[i];
+            for (auto j = store->parent_offsets[i]; j < store->parent_offsets[i + 1]; j++) {
+                if (store->tasks[store->parents[j]]->getState() != WorkflowTask::State::COMPLETED) {
+                    num_remaining_parents[i]++;
+                }
+            }
+            if (num_remaining_parents[i] == 0) {
+                ready.push_back(i);
+            }
+        }
+        double critical_path = 0.0;
+        while (not ready.empty()) {
+            auto i = ready.back();
+            ready.pop_back();
+            path_lengths[i] += runtimes[i];
+            critical_path = std::max(critical_path, path_lengths[i]);
+            for (auto j = store->child_offsets[i]; j < store->child_offsets[i + 1]; j++) {
+                auto child = store->children[j];
+                path_lengths[child] = std::max(path_lengths[child], path_lengths[i]);
+                if (--num_remaining_parents[child] == 0) {
+                    ready.push_back(child);
+                }
+            }
+        }
+
+        // Cores available outside of the pilot job (the VMs; the accelerated tasks are not counted)
+        double other_cores = 0.0;
+        for (auto const &cs: this->vm_compute_services) {
+            other_cores += (double) this->total_cores_map.at(cs);
+        }
+
+        unsigned long best_num_nodes = 1;
+        double best_energy = std::numeric_limits<double>::infinity();
+        for (unsigned long num_nodes = 1; num_nodes <= this->powered_down_hosts.size(); num_nodes++) {
+            // The batch scheduler picks the nodes: the first powered-down ones stand for them
+            double node_idle_power = 0.0;
+            double boot_energy = 0.0;
+            auto hostname = this->powered_down_hosts.begin();
+            for (unsigned long n = 0; n < num_nodes; n++, hostname++) {
+                auto const &profile = HostPowerProfile::fromHost(*hostname, 0);
+                node_idle_power += profile.idle_watts;
+                boot_energy += profile.idle_watts * HostPowerProfile::getBootTime(*hostname);
+            }
+            double node_cores = (double) this->batch_hosts.begin()->second;
+            double num_cores = (double) num_nodes * node_cores + other_cores;
+            double duration = std::max(critical_path, remaining_work / num_cores);
+            double energy = boot_energy + (this->always_on_idle_power + node_idle_power) * duration;
+            // The power above idle of each host at its average load over the run
+            if (duration > 0.0) {
+                auto const &node_profile = HostPowerProfile::fromHost(*this->powered_down_hosts.begin(), 0);
+                double node_busy_cores = remaining_work / num_cores * node_cores / duration;
+                energy += (double) num_nodes * (node_profile.getPower(node_busy_cores) - node_profile.idle_watts) * duration;
+                for (auto const &cs: this->vm_compute_services) {
+                    auto const &vm_profile = this->power_profile_map.at(cs);
+                    double vm_busy_cores = remaining_work / num_cores * (double) this->total_cores_map.at(cs) / duration;
+                    energy += (vm_profile.getPower(vm_busy_cores) - vm_profile.idle_watts) * duration;
+                }
+            }
+            if (energy < best_energy) {
+                best_energy = energy;
+                best_num_nodes = num_nodes;
+            }
+        }
+        WRENCH_INFO("Requesting %lu pilot job nodes (predicted energy %.2lf J)", best_num_nodes, best_energy);
+        return best_num_nodes;
+    }
+
+    /**
+     * @brief Power down batch compute nodes, i.e., set them in their sleep pstate (if they have one)
+     *
+     * @param hostnames: the names of batch compute nodes
+     */
+    void SimpleWMS::powerDownBatchHosts(const std::vector<std::string> &hostnames) {
+        for (auto const &hostname: hostnames) {
+            auto sleep_pstate = HostPowerProfile::getSleepPstate(hostname);
+            if (sleep_pstate >= 0) {
+                recordDecision("power_down", hostname, std::to_string(sleep_pstate));
+                this->simulation_->setPstate(hostname, sleep_pstate);
+                this->powered_down_hosts.insert(hostname);
+            }
+        }
+    }
+
+    /**
+     * @brief Power up batch compute nodes, i.e., set the powered-down ones in their fastest pstate
+     *
+     * @param hostnames: the names of batch compute nodes
+     * @return the time until all the nodes are usable, in seconds
+     */
+    double SimpleWMS::powerUpBatchHosts(const std::vector<std::string> &hostnames) {
+        double boot_time = 0.0;
+        for (auto const &hostname: hostnames) {
+            if (this->powered_down_hosts.erase(hostname)) {
+                recordDecision("power_up", hostname, "0");
+                this->simulation_->setPstate(hostname, 0);
+                boot_time = std::max(boot_time, HostPowerProfile::getBootTime(hostname));
+                this->metrics["batch_node_boots"]++;
+            }
+        }
+        return boot_time;
+    }
+
+    /**
+     * @brief Record a decision in the decision log (if any), and abort the workflow execution if requested
+     *        once the run has diverged from the baseline
+     *
+     * @param kind: the decision kind
+     * @param subject: what the decision is about
+     * @param target: what was decided
+     */
+    void SimpleWMS::recordDecision(const std::string &kind, const std::string &subject, const std::string &target) {
+        if (not this->decision_log) {
+            return;
+        }
+        if (this->decision_log->record({Simulation::getCurrentSimulatedDate(), kind, subject, target}) and
+            this->stop_at_divergence and not this->abort) {
+            WRENCH_INFO("Decision %lu differs from the baseline: aborting", this->decision_log->getNumDecisions() - 1);
+            this->abort = true;
+        }
     }
 
 }// namespace wrench
@@ -11,14 +11,72 @@
 #include <wrench.h>
 
 
+#include <cmath>
 #include <fstream>
+#include <sstream>
 #include <string>
 
 #include "SimpleWMS.h"
+#include "EnergyKernel.h"
+#include "WfFormatLoader.h"
+#include "RecipeRepository.h"
+#include "ContextConfiguration.h"
+#include "SchedulePlan.h"
+#include "InterferenceModel.h"
+#include "ResultsDatabase.h"
 
 ///usr/local/include/wrench/tools/wfcommons/WfCommonsWorkflowParser.h
 #include <wrench/tools/wfcommons/WfCommonsWorkflowParser.h>
 
+/**
+ * @brief A row of the results file, i.e., the results of the run for one host
+ */
+struct HostResultRow
+{
+    std::string run_id;
+    std::string host_name;
+    int num_of_cores;
+    std::string cores_allocated_task;
+    int num_of_tasks;
+    double avg_task_execution;
+    unsigned long tasks_failed;
+    double compute_time;
+    double io_input_time;
+    double io_output_time;
+    double comm_comp_ratio;
+    unsigned long total_bytes_read;
+    unsigned long total_bytes_write;
+    double completion_date;
+    double power;
+};
+
+/**
+ * @brief Format a row of the results file (called by the background writer thread)
+ *
+ * @param row: the row
+ * @param out: the string to which the CSV line is appended
+ */
+static void formatHostResultRow(const HostResultRow &row, std::string &out)
+{
+    std::ostringstream line;
+    line << row.run_id << ","
+         << row.host_name << ","
+         << row.num_of_cores << ","
+         << row.cores_allocated_task << ","
+         << row.num_of_tasks << ","
+         << row.avg_task_execution << ","
+         << row.tasks_failed << ","
+         << row.compute_time << ","
+         << row.io_input_time << ","
+         << row.io_output_time << ","
+         << row.comm_comp_ratio << ","
+         << row.total_bytes_read << ","
+         << row.total_bytes_write << ","
+         << row.completion_date << ","
+         << row.power << "\n";
+    out += line.str();
+}
+
 /**
  * @brief An example that demonstrate how to run a simulation of a simple Workflow
  *        Management System (WMS) (implemented in SimpleWMS.[cpp|h]).
@@ -31,24 +89,219 @@
 int main(int argc, char **argv)
 {
 
+    /* The SimGrid context backend and actor stack size are set before SimGrid is initialized, from the workflow size */
+    std::vector<std::string> arguments(argv, argv + argc);
+    std::map<std::string, std::string> context_options;
+    std::vector<std::string> workflow_args;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        for (auto const &name : {"context-factory", "context-stack-size", "context-threads", "context-parallel-threshold", "recipe-repository"})
+        {
+            if (arg.rfind(std::string("--") + name + "=", 0) == 0)
+            {
+                context_options[name] = arg.substr(arg.find('=') + 1);
+            }
+        }
+        if (arg.rfind("--", 0) != 0)
+        {
+            workflow_args.push_back(arg);
+        }
+    }
+    unsigned long estimated_num_tasks = workflow_args.size() == 2 ? wrench::ContextConfiguration::countTasks(workflow_args[1], context_options["recipe-repository"]) : 0;
+    try
+    {
+        auto config_arguments = wrench::ContextConfiguration::getConfigArguments(
+            estimated_num_tasks, context_options["context-factory"], context_options["context-stack-size"],
+            context_options["context-threads"], context_options["context-parallel-threshold"], arguments);
+        arguments.insert(arguments.begin() + 1, config_arguments.begin(), config_arguments.end());
+    }
+    catch (std::invalid_argument &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        exit(1);
+    }
+    std::vector<char *> init_argv;
+    for (auto &argument : arguments)
+    {
+        init_argv.push_back(&argument[0]);
+    }
+    init_argv.push_back(nullptr);
+    argc = (int)arguments.size();
+    argv = init_argv.data();
+
     auto simulation = wrench::Simulation::createSimulation();
 
     simulation->init(&argc, argv);
 
-    if (argc != 3)
+    std::string context_factory = simgrid::s4u::Engine::get_config<std::string>("contexts/factory");
+    int context_stack_size = simgrid::s4u::Engine::get_config<int>("contexts/stack-size");
+    int context_threads = simgrid::s4u::Engine::get_config<int>("contexts/nthreads");
+    int context_parallel_threshold = simgrid::s4u::Engine::get_config<int>("contexts/parallel-threshold");
+    std::cerr << "SimGrid contexts: " << context_factory << ", " << context_stack_size << " KiB stacks, " << context_threads
+              << " threads (" << estimated_num_tasks << " tasks)" << std::endl;
+
+    /* Separate the simulator options (--name=value) from the positional arguments */
+    std::map<std::string, std::string> options;
+    std::vector<char *> positional_args;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) == 0)
+        {
+            auto separator = arg.find('=');
+            options[arg.substr(2, separator - 2)] = (separator == std::string::npos) ? "" : arg.substr(separator + 1);
+        }
+        else
+        {
+            positional_args.push_back(argv[i]);
+        }
+    }
+
+    if (positional_args.size() != 2)
     {
         std::cerr << "Usage: " << argv[0] << " <xml platform file> <workflow file> [--log=simple_wms.threshold=info]" << std::endl;
+        std::cerr << "   [--workflow-loader=wfcommons|simdjson] [--reference-flop-rate=<flop rate of the recorded task runtimes, default 100Gf>]" << std::endl;
+        std::cerr << "   [--output-dir=<directory of the result files, default /home/wrench/datas>]" << std::endl;
+        std::cerr << "   [--recipe-repository=<packed recipe file>] (the workflow is then given as <family>/<number of tasks>/<seed>)" << std::endl;
+        std::cerr << "   [--accelerator-speedups=<category>:<speedup>[,<category>:<speedup>...]]" << std::endl;
+        std::cerr << "   [--dvfs=performance|powersave|energy (pstate selection on platforms with several pstates, default performance)]" << std::endl;
+        std::cerr << "   [--socket-placement=spread|consolidate (tasks of a node on its CPU sockets, on platforms generated with --sockets, default spread)]" << std::endl;
+        std::cerr << "   [--placement=first-fit|consolidate (tasks on the compute services, consolidate fills busy nodes first, default first-fit)]" << std::endl;
+        std::cerr << "   [--power-down-delay=<seconds an idle pilot job node stays up with consolidated placement, default its break-even time>]" << std::endl;
+        std::cerr << "   [--interference-slowdown=<slowdown of a memory-bound task on a node full of memory-bound tasks, e.g. 1.5>]" << std::endl;
+        std::cerr << "   [--interference-intensities=<category>:<memory intensity in [0, 1]>[,...]] [--avoid-interference]" << std::endl;
+        std::cerr << "   [--interference-bytes-per-flop=<bytes per flop of a memory-bound task, default: memory_bandwidth property of the nodes over their flop rate>]" << std::endl;
+        std::cerr << "   [--predictor-alpha=<weight in (0,1] of the latest observation in the runtime predictor, default 0.3>]" << std::endl;
+        std::cerr << "   [--trace=<task trace file>] [--trace-compression=zstd]" << std::endl;
+        std::cerr << "   [--timeline=<binary Gantt and host utilization timeline file>]" << std::endl;
+        std::cerr << "   [--context-factory=auto|raw|ucontext|thread|boost] [--context-stack-size=auto|<KiB>] (SimGrid contexts, default from the workflow size)" << std::endl;
+        std::cerr << "   [--context-threads=auto|<n>] [--context-parallel-threshold=<ready actors, default 16>] (parallel actor execution, default sequential)" << std::endl;
+        std::cerr << "   [--policy-fds=<read fd>,<write fd>] (task placement by an external policy, see src/wrench_env.py)" << std::endl;
+        std::cerr << "   [--schedule-plan=<plan file>] (static schedule computed offline, see src/plan_schedule.py)" << std::endl;
+        std::cerr << "   [--profile-simulation] (simulation rate counters, written to execution_metrics.csv)" << std::endl;
+        std::cerr << "   [--results-db=<SQLite results database, see src/results_db.py>]" << std::endl;
+        std::cerr << "   [--decision-log=<WMS decision log file>] [--baseline-decisions=<decision log of a baseline run>] [--stop-at-divergence]" << std::endl;
+        std::cerr << "   [--energy-windows=<start>:<end>[,<start>:<end>...]] [--power-histogram-bins=<number of bins, default 10>]" << std::endl;
+        std::cerr << "   [--power-timelines] (per-host power timelines, written to power_timelines.csv, see src/energy_windows.py)" << std::endl;
         exit(1);
     }
 
     /* The first argument is the platform description file, written in XML following the SimGrid-defined DTD */
-    char *platform_file = argv[1];
-    /* The second argument is the workflow description file, written in JSON using WfCommons's WfFormat format */
-    char *workflow_file = argv[2];
+    char *platform_file = positional_args[0];
+    /* The second argument is the workflow description file, written in JSON using WfCommons's WfFormat format
+       (or, with --recipe-repository, the key of a packed recipe) */
+    char *workflow_file = positional_args[1];
+
+    /* Task categories eligible for acceleration, with their speedup over a CPU core */
+    std::map<std::string, double> accelerator_speedups;
+    if (options.count("accelerator-speedups"))
+    {
+        std::istringstream entries(options["accelerator-speedups"]);
+        std::string entry;
+        while (std::getline(entries, entry, ','))
+        {
+            auto separator = entry.find(':');
+            try
+            {
+                accelerator_speedups[entry.substr(0, separator)] = std::stod(entry.substr(separator + 1));
+            }
+            catch (std::exception &e)
+            {
+                std::cerr << "Error: invalid accelerator speedup '" << entry << "'" << std::endl;
+                exit(1);
+            }
+        }
+    }
+
+    /* Time windows of the energy report, checked before simulating */
+    std::vector<std::pair<double, double>> energy_windows;
+    unsigned long num_histogram_bins = 10;
+    if (options.count("energy-windows"))
+    {
+        std::istringstream windows(options["energy-windows"]);
+        std::string window;
+        while (std::getline(windows, window, ','))
+        {
+            auto separator = window.find(':');
+            try
+            {
+                if (separator == std::string::npos)
+                {
+                    throw std::invalid_argument("missing end date");
+                }
+                double start = std::stod(window.substr(0, separator));
+                double end = std::stod(window.substr(separator + 1));
+                // As in src/energy_windows.py
+                if (not(start >= 0.0 and std::isfinite(start)) or not(end >= start))
+                {
+                    throw std::invalid_argument("invalid dates");
+                }
+                energy_windows.emplace_back(start, end);
+            }
+            catch (std::exception &e)
+            {
+                std::cerr << "Error: invalid energy window '" << window << "' (expected <start>:<end>, with 0 <= start <= end)" << std::endl;
+                exit(1);
+            }
+        }
+        try
+        {
+            if (options.count("power-histogram-bins"))
+            {
+                num_histogram_bins = std::stoul(options["power-histogram-bins"]);
+            }
+        }
+        catch (std::exception &e)
+        {
+            std::cerr << "Error: invalid number of power histogram bins '" << options["power-histogram-bins"] << "'" << std::endl;
+            exit(1);
+        }
+    }
+
+    /* The flop rate of the machines the task runtimes were recorded on (calibrated with src/calibrate.py) */
+    std::string reference_flop_rate = options.count("reference-flop-rate") ? options["reference-flop-rate"] : "100Gf";
+    /* The directory the result files are appended to */
+    std::string output_dir = options.count("output-dir") ? options["output-dir"] : "/home/wrench/datas";
 
     std::cerr << "Loading workflow..." << std::endl;
     std::shared_ptr<wrench::Workflow> workflow;
-    workflow = wrench::WfCommonsWorkflowParser::createWorkflowFromJSON(workflow_file, "100Gf");
+    std::string workflow_loader = options.count("workflow-loader") ? options["workflow-loader"] : "wfcommons";
+    if (options.count("recipe-repository"))
+    {
+        try
+        {
+            wrench::RecipeRepository recipe_repository(options["recipe-repository"]);
+            workflow = recipe_repository.createWorkflow(workflow_file, reference_flop_rate);
+        }
+        catch (std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            exit(1);
+        }
+    }
+    else if (workflow_loader == "simdjson")
+    {
+        if (not wrench::WfFormatLoader::isAvailable())
+        {
+            std::cerr << "Error: the simdjson workflow loader requires a simulator built with simdjson" << std::endl;
+            exit(1);
+        }
+        workflow = wrench::WfFormatLoader::createWorkflowFromJSON(workflow_file, reference_flop_rate);
+    }
+    else if (workflow_loader != "wfcommons")
+    {
+        std::cerr << "Error: unknown workflow loader '" << workflow_loader << "'" << std::endl;
+        exit(1);
+    }
+    else
+    {
+        /* Tasks use the core counts of the recipe, as with the other loaders */
+        workflow = wrench::WfCommonsWorkflowParser::createWorkflowFromJSON(workflow_file, reference_flop_rate, false, false,
+                                                                           false, 1, 1, true);
+    }
+    /* Assign dense IDs to the tasks and files, and keep their metadata in contiguous arrays */
+    auto task_graph_store = std::make_shared<wrench::TaskGraphStore>(workflow);
     std::cerr.flush();
 
     /* Reading and parsing the platform description file to instantiate a simulated platform */
@@ -103,10 +356,148 @@ int main(int argc, char **argv)
         std::exit(1);
     }
 
+    /* Instantiate a bare-metal service on the accelerator-equipped nodes, if the platform has any */
+    std::vector<std::string> accelerator_hosts;
+    for (auto const &host_name : hostname_list)
+    {
+        const char *node_class = simgrid::s4u::Host::by_name(host_name)->get_property("node_class");
+        if (node_class != nullptr and std::string(node_class) == "accelerator")
+        {
+            accelerator_hosts.push_back(host_name);
+        }
+    }
+    std::shared_ptr<wrench::BareMetalComputeService> accelerator_compute_service;
+    if (not accelerator_hosts.empty())
+    {
+        std::cerr << "Instantiating a BareMetalComputeService on " << accelerator_hosts.size() << " accelerator nodes..." << std::endl;
+        accelerator_compute_service = simulation->add(new wrench::BareMetalComputeService(
+            "WMSHost", accelerator_hosts, "", {}, {}));
+    }
+
     std::cerr << "Instantiating a WMS on WMSHost..." << std::endl;
     auto wms = simulation->add(
-        new wrench::SimpleWMS(workflow, batch_compute_service,
+        new wrench::SimpleWMS(workflow, task_graph_store, batch_compute_service,
                               cloud_compute_service, storage_service, {"WMSHost"}));
+    if (accelerator_compute_service)
+    {
+        wms->setAcceleratorComputeService(accelerator_compute_service, accelerator_speedups);
+    }
+    if (options.count("dvfs"))
+    {
+        try
+        {
+            wms->setDvfsPolicy(options["dvfs"]);
+        }
+        catch (std::invalid_argument &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            exit(1);
+        }
+    }
+    /* Co-located tasks slow each other down by memory bandwidth and cache contention */
+    if (options.count("interference-slowdown"))
+    {
+        std::map<std::string, double> interference_intensities;
+        std::istringstream entries(options.count("interference-intensities") ? options["interference-intensities"] : "");
+        std::string entry;
+        while (std::getline(entries, entry, ','))
+        {
+            auto separator = entry.find(':');
+            try
+            {
+                interference_intensities[entry.substr(0, separator)] = std::stod(entry.substr(separator + 1));
+            }
+            catch (std::exception &e)
+            {
+                std::cerr << "Error: invalid memory intensity '" << entry << "'" << std::endl;
+                exit(1);
+            }
+        }
+        /* A memory-bound task moves as many bytes per flop as a node can: its memory bandwidth over its flop rate */
+        double reference_bytes_per_flop = wrench::InterferenceModel::DEFAULT_REFERENCE_BYTES_PER_FLOP;
+        auto reference_host = simgrid::s4u::Host::by_name("Node1");
+        const char *memory_bandwidth = reference_host->get_property("memory_bandwidth");
+        try
+        {
+            if (options.count("interference-bytes-per-flop"))
+            {
+                reference_bytes_per_flop = std::stod(options["interference-bytes-per-flop"]);
+            }
+            else if (memory_bandwidth != nullptr)
+            {
+                reference_bytes_per_flop = std::stod(memory_bandwidth) / (reference_host->get_speed() * reference_host->get_core_count());
+            }
+        }
+        catch (std::exception &e)
+        {
+            std::cerr << "Error: invalid reference bytes per flop" << std::endl;
+            exit(1);
+        }
+        try
+        {
+            wms->setInterferenceModel(std::make_shared<wrench::InterferenceModel>(*task_graph_store, std::stod(options["interference-slowdown"]),
+                                                                                  reference_bytes_per_flop, interference_intensities),
+                                      options.count("avoid-interference") > 0);
+        }
+        catch (std::invalid_argument &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            exit(1);
+        }
+    }
+    if (options.count("socket-placement"))
+    {
+        try
+        {
+            wms->setSocketPlacement(options["socket-placement"]);
+        }
+        catch (std::invalid_argument &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            exit(1);
+        }
+    }
+    if (options.count("placement"))
+    {
+        try
+        {
+            wms->setPlacementPolicy(options["placement"]);
+        }
+        catch (std::invalid_argument &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            exit(1);
+        }
+    }
+    if (options.count("power-down-delay"))
+    {
+        try
+        {
+            wms->setPowerDownDelay(std::stod(options["power-down-delay"]));
+        }
+        catch (std::exception &e)
+        {
+            std::cerr << "Error: invalid power-down delay '" << options["power-down-delay"] << "'" << std::endl;
+            exit(1);
+        }
+    }
+    if (options.count("predictor-alpha"))
+    {
+        try
+        {
+            double alpha = std::stod(options["predictor-alpha"]);
+            if (not(alpha > 0.0 and alpha <= 1.0))
+            {
+                throw std::out_of_range("alpha");
+            }
+            wms->setRuntimePredictor(wrench::RuntimePredictor(alpha));
+        }
+        catch (std::exception &e)
+        {
+            std::cerr << "Error: invalid predictor alpha '" << options["predictor-alpha"] << "' (expected a weight in (0,1])" << std::endl;
+            exit(1);
+        }
+    }
 
     /* Instantiate a file registry service */
     std::string file_registry_service_host = hostname_list[(hostname_list.size() > 2) ? 1 : 0];
@@ -133,12 +524,133 @@ int main(int argc, char **argv)
         }
     }
 
+    /* Task events are handed to a background writer thread, so that the simulation never blocks on I/O */
+    std::shared_ptr<wrench::AsyncWriter<wrench::TaskTraceRecord>> trace_writer;
+    if (options.count("trace"))
+    {
+        try
+        {
+            trace_writer = std::make_shared<wrench::AsyncWriter<wrench::TaskTraceRecord>>(
+                options["trace"],
+                [task_graph_store](const wrench::TaskTraceRecord &record, std::string &out)
+                {
+                    out += std::to_string(record.date) + "," + task_graph_store->tasks[record.task_index]->getID() + "," +
+                           (record.failed ? "failed" : "completed") + "," + record.execution_host + "," +
+                           std::to_string(record.num_cores) + "," + std::to_string(record.start_date) + "," +
+                           std::to_string(record.end_date) + "\n";
+                },
+                false, options["trace-compression"] == "zstd", "date,task_id,event,host_name,num_cores,start_date,end_date\n");
+        }
+        catch (std::runtime_error &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            std::exit(1);
+        }
+        wms->setTraceWriter(trace_writer);
+    }
+
+    /* The results are also inserted into an embedded database, if requested (see src/results_db.py) */
+    std::unique_ptr<wrench::ResultsDatabase> results_database;
+    if (options.count("results-db"))
+    {
+        try
+        {
+            results_database = std::make_unique<wrench::ResultsDatabase>(options["results-db"]);
+        }
+        catch (std::runtime_error &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            std::exit(1);
+        }
+    }
+
+    /* Task executions and host utilization intervals are streamed to a binary file (see notebooks/timeline.py) */
+    std::shared_ptr<wrench::TimelineRecorder> timeline_recorder;
+    if (options.count("timeline"))
+    {
+        std::vector<std::string> task_ids;
+        task_ids.reserve(task_graph_store->getNumTasks());
+        for (auto const &task : task_graph_store->tasks)
+        {
+            task_ids.push_back(task->getID());
+        }
+        try
+        {
+            timeline_recorder = std::make_shared<wrench::TimelineRecorder>(options["timeline"], hostname_list, task_ids);
+        }
+        catch (std::runtime_error &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            std::exit(1);
+        }
+        wms->setTimelineRecorder(timeline_recorder);
+    }
+
+    /* The WMS decisions are logged, and compared with those of a baseline run to find where the two runs diverge */
+    std::shared_ptr<wrench::DecisionLog> decision_log;
+    if (options.count("decision-log") || options.count("baseline-decisions"))
+    {
+        try
+        {
+            decision_log = std::make_shared<wrench::DecisionLog>(options.count("decision-log") ? options["decision-log"] : "",
+                                                                 options.count("baseline-decisions") ? options["baseline-decisions"] : "");
+        }
+        catch (std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            std::exit(1);
+        }
+        wms->setDecisionLog(decision_log, options.count("stop-at-divergence") > 0);
+    }
+
+    /* The ready tasks are placed by an external policy (e.g., a learned scheduler trained with src/wrench_env.py) */
+    if (options.count("policy-fds"))
+    {
+        try
+        {
+            auto fds = wrench::PolicyChannel::parseFileDescriptors(options["policy-fds"]);
+            wms->setPolicyChannel(std::make_shared<wrench::PolicyChannel>(fds.first, fds.second));
+        }
+        catch (std::invalid_argument &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            std::exit(1);
+        }
+    }
+
+    /* The tasks run where and in the order a static schedule plan says (e.g., computed by src/plan_schedule.py) */
+    if (options.count("schedule-plan"))
+    {
+        try
+        {
+            wms->setSchedulePlan(std::make_shared<wrench::SchedulePlan>(options["schedule-plan"], *task_graph_store));
+        }
+        catch (std::invalid_argument &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            std::exit(1);
+        }
+    }
+
+    /* Simulation rate counters (actors, messages, activities, time spent in the WMS vs the rest of the simulation) */
+    std::shared_ptr<wrench::SimulationProfiler> profiler;
+    if (options.count("profile-simulation"))
+    {
+        profiler = std::make_shared<wrench::SimulationProfiler>();
+        profiler->install();
+        wms->setProfiler(profiler);
+    }
+
     /* Enable some output time stamps */
     simulation->getOutput().enableWorkflowTaskTimestamps(true);
     simulation->getOutput().enableEnergyTimestamps(true);
 
     /* Launch the simulation. This call only returns when the simulation is complete. */
     std::cerr << "Launching the Simulation..." << std::endl;
+    if (profiler)
+    {
+        profiler->start();
+    }
     try
     {
         simulation->launch();
@@ -148,6 +660,52 @@ int main(int argc, char **argv)
         std::cerr << "Exception: " << e.what() << std::endl;
         return 0;
     }
+    if (profiler)
+    {
+        profiler->stop();
+        auto counters = profiler->getCounters();
+        std::cerr << "Simulation rate: " << counters["sim_wall_time"] << " s (" << counters["sim_wms_time"] << " s in the WMS), "
+                  << counters["sim_max_live_actors"] << " actors at most, " << counters["sim_comms_started"] << " communications ("
+                  << counters["sim_max_pending_comms"] << " pending at most), "
+                  << counters["sim_activities_per_second"] << " activities/s, " << counters["sim_wms_events_per_second"]
+                  << " WMS events/s" << std::endl;
+    }
+
+    /* A trace, timeline or decision log that could not be written entirely fails the run */
+    try
+    {
+        if (trace_writer)
+        {
+            trace_writer->close();
+        }
+        if (timeline_recorder)
+        {
+            timeline_recorder->close();
+        }
+        if (decision_log)
+        {
+            decision_log->close();
+        }
+    }
+    catch (std::runtime_error &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    /* An aborted run (e.g., stopped at its first divergence from the baseline) has no completion date: its
+       results are not written, and the run fails */
+    if (not workflow->isDone())
+    {
+        std::cerr << "Error: the workflow execution is incomplete, no results are written";
+        if (decision_log and decision_log->getFirstDivergence() >= 0)
+        {
+            std::cerr << " (decision " << decision_log->getFirstDivergence() << " at date "
+                      << decision_log->getFirstDivergenceDate() << " differs from the baseline)";
+        }
+        std::cerr << std::endl;
+        return 2;
+    }
 
     simulation->getOutput().dumpWorkflowGraphJSON(workflow, "/tmp/workflow.json", true);
 
@@ -187,20 +745,20 @@ int main(int argc, char **argv)
 
     computation_communication_ratio_average /= (double)(trace.size());
 
-    std::ofstream csvFile;
-
-    csvFile.open("/home/wrench/datas/execution_output.csv", std::ios::app);
-
-    if (!csvFile.is_open())
+    /* The result rows are formatted and appended to the CSV file by a background writer thread */
+    std::shared_ptr<wrench::AsyncWriter<HostResultRow>> csvFile;
+    try
     {
-        std::cerr << "Erro ao abrir o arquivo CSV!" << std::endl;
-        std::cerr << "Erro do sistema: " << strerror(errno) << std::endl;
+        /* The header is added only the first time the file is opened; the queue holds the row of each host */
+        csvFile = std::make_shared<wrench::AsyncWriter<HostResultRow>>(
+            output_dir + "/execution_output.csv", formatHostResultRow, true, false,
+            "run_id,host_name,num_of_cores,cores_allocated_task,num_of_tasks,avg_task_execution,tasks_failed,compute_time,io_input_time,io_output_time,comm_comp_ratio,total_bytes_read,total_bytes_write,completion_date,power\n",
+            hostname_list.size());
     }
-
-    /* Add the header only the first time you open the file */
-    if (csvFile.tellp() == 0)
+    catch (std::runtime_error &e)
     {
-        csvFile << "run_id,host_name,num_of_cores,cores_allocated_task,num_of_tasks,avg_task_execution,tasks_failed,compute_time,io_input_time,io_output_time,comm_comp_ratio,total_bytes_read,total_bytes_write,completion_date,power\n";
+        std::cerr << "Erro ao abrir o arquivo CSV!" << std::endl;
+        std::cerr << "Erro do sistema: " << e.what() << std::endl;
     }
 
     //csvFile << std::fixed << std::setprecision(2);
@@ -229,15 +787,17 @@ int main(int argc, char **argv)
         }
     }
 
-    int lista_de_nos = simulation->getHostnameList().size();
+    /* return current energy consumption in joules, for all hosts at once */
+    std::map<std::string, double> energy_per_host = simulation->getEnergyConsumed(hostname_list);
+
+    int lista_de_nos = hostname_list.size();
     for (int index = 0; index < lista_de_nos; index++)
     {
-        std::string host_name = simulation->getHostnameList()[index];
+        std::string host_name = hostname_list[index];
         int num_tasks = workflow->getNumberOfTasks();
         int num_cores = simulation->getHostNumCores(host_name);
         std::string runId = "extk-" + std::to_string(num_tasks);
-        /* return current energy consumption in joules */
-        double energy_consumed = simulation->getEnergyConsumed(host_name);
+        double energy_consumed = energy_per_host[host_name];
         /* return a date in seconds */
         double conclusion_time = workflow->getCompletionDate();
 
@@ -247,26 +807,226 @@ int main(int argc, char **argv)
         /* Average time per task in seconds */
         double avg_task_duration = compute_time / (num_tasks - num_failed_tasks);
 
-        csvFile << runId << ","
-                << host_name << ","
-                << num_cores << ","
-                << cores_stream.str() << ","
-                << num_tasks << ","
-                << avg_task_duration << ","
-                //<< memory_stream.str() << ","
-                //<< trace.size() << ","
-                << num_failed_tasks << ","
-                << compute_time << ","
-                << io_time_input << ","
-                << io_time_output << ","
-                << computation_communication_ratio_average << ","
-                << total_bytes_read << ","
-                << total_bytes_write << ","
-                << conclusion_time << ","
-                // << flops_stream.str() << ","
-                << power << "\n";
-    }
-    csvFile.close();
+        if (csvFile)
+        {
+            csvFile->write({runId, host_name, num_cores, cores_stream.str(), num_tasks, avg_task_duration, num_failed_tasks,
+                            compute_time, io_time_input, io_time_output, computation_communication_ratio_average,
+                            total_bytes_read, total_bytes_write, conclusion_time, power});
+        }
+    }
+
+    /* Per-host power timelines, rebuilt from the task executions and pstate changes */
+    std::map<std::string, unsigned long> host_index;
+    std::vector<std::vector<wrench::HostPowerProfile>> pstate_profiles;
+    double max_power = 0.0;
+    bool socket_aware_hosts = false;
+    for (auto const &host_name : hostname_list)
+    {
+        host_index[host_name] = pstate_profiles.size();
+        pstate_profiles.push_back(wrench::HostPowerProfile::getPstateProfiles(host_name));
+        max_power = std::max(max_power, pstate_profiles.back().front().all_cores_watts);
+        socket_aware_hosts = socket_aware_hosts or pstate_profiles.back().front().isSocketAware();
+    }
+    std::vector<wrench::UtilizationInterval> intervals;
+    intervals.reserve(trace.size());
+    for (const auto &item : trace)
+    {
+        auto execution = item->getContent()->getTask()->getExecutionHistory().top();
+        intervals.push_back({host_index[execution.physical_execution_host], execution.computation_start,
+                             execution.computation_end, execution.num_cores_allocated});
+    }
+    std::vector<wrench::PstateChange> pstate_changes;
+    for (const auto &item : simulation->getOutput().getTrace<wrench::SimulationTimestampPstateSet>())
+    {
+        pstate_changes.push_back({host_index[item->getContent()->getHostname()], item->getDate(),
+                                  (unsigned long)item->getContent()->getPstate()});
+    }
+    bool consolidated_sockets = options.count("socket-placement") and options["socket-placement"] == "consolidate";
+    wrench::PowerTimelines timelines(hostname_list, pstate_profiles, intervals, pstate_changes,
+                                     wrench::Simulation::getCurrentSimulatedDate(), consolidated_sockets);
+
+    /* SimGrid models hosts as flat multicore machines: the energy of the socket-aware model is reported
+       along with that of the host-level model on the same timelines, to quantify socket gating */
+    std::map<std::string, double> socket_metrics;
+    if (socket_aware_hosts)
+    {
+        auto flat_profiles = pstate_profiles;
+        for (auto &profiles : flat_profiles)
+        {
+            for (auto &profile : profiles)
+            {
+                profile.num_sockets = 1;
+                profile.gated_socket_watts = -1.0;
+            }
+        }
+        wrench::PowerTimelines flat_timelines(hostname_list, flat_profiles, intervals, pstate_changes,
+                                              wrench::Simulation::getCurrentSimulatedDate());
+        auto socket_report = timelines.integrate(0.0, timelines.getHorizon());
+        auto flat_report = flat_timelines.integrate(0.0, flat_timelines.getHorizon());
+        for (unsigned long host = 0; host < hostname_list.size(); host++)
+        {
+            socket_metrics["socket_model_energy"] += socket_report.energy[host];
+            socket_metrics["host_model_energy"] += flat_report.energy[host];
+        }
+    }
+
+    /* The per-host power timelines themselves, so that other windows can be computed offline (see src/energy_windows.py) */
+    if (options.count("power-timelines"))
+    {
+        std::ofstream timelinesFile(output_dir + "/power_timelines.csv", std::ios::app);
+        timelinesFile.precision(15);
+        if (timelinesFile.tellp() == 0)
+        {
+            timelinesFile << "run_id,host_name,start_date,end_date,power\n";
+        }
+        std::string timelinesRunId = "extk-" + std::to_string(workflow->getNumberOfTasks());
+        for (unsigned long host = 0; host < hostname_list.size(); host++)
+        {
+            for (auto i = timelines.offsets[host]; i < timelines.offsets[host + 1]; i++)
+            {
+                timelinesFile << timelinesRunId << "," << hostname_list[host] << "," << timelines.start_dates[i] << ","
+                              << timelines.end_dates[i] << "," << timelines.powers[i] << "\n";
+            }
+        }
+    }
+
+    /* Energy and power of each host over the requested time windows, computed from the per-host power timelines */
+    if (options.count("energy-windows"))
+    {
+        unsigned long num_bins = num_histogram_bins;
+        std::vector<double> histogram_edges;
+        for (unsigned long bin = 0; bin <= num_bins; bin++)
+        {
+            histogram_edges.push_back(max_power * (double)bin / (double)num_bins);
+        }
+
+        std::ofstream windowsFile(output_dir + "/energy_windows.csv", std::ios::app);
+        std::ofstream histogramFile(output_dir + "/power_histogram.csv", std::ios::app);
+        if (windowsFile.tellp() == 0)
+        {
+            windowsFile << "run_id,host_name,window_start,window_end,energy,average_power,peak_power\n";
+        }
+        if (histogramFile.tellp() == 0)
+        {
+            histogramFile << "run_id,host_name,window_start,window_end,power_low,power_high,seconds\n";
+        }
+        std::string windowsRunId = "extk-" + std::to_string(workflow->getNumberOfTasks());
+        for (auto const &window : energy_windows)
+        {
+            auto report = timelines.integrate(window.first, window.second, histogram_edges);
+            for (unsigned long host = 0; host < hostname_list.size(); host++)
+            {
+                windowsFile << windowsRunId << "," << hostname_list[host] << "," << report.window_start << ","
+                            << report.window_end << "," << report.energy[host] << "," << report.average_power[host] << ","
+                            << report.peak_power[host] << "\n";
+                for (unsigned long bin = 0; bin < num_bins; bin++)
+                {
+                    histogramFile << windowsRunId << "," << hostname_list[host] << "," << report.window_start << ","
+                                  << report.window_end << "," << histogram_edges[bin] << "," << histogram_edges[bin + 1] << ","
+                                  << report.histogram[host * num_bins + bin] << "\n";
+                }
+            }
+        }
+    }
+
+    /* The execution of each task compared with the schedule plan */
+    if (options.count("schedule-plan"))
+    {
+        std::ofstream deviationsFile(output_dir + "/plan_deviations.csv", std::ios::app);
+        if (deviationsFile.tellp() == 0)
+        {
+            deviationsFile << "run_id,task_id,service,planned_start,actual_start,planned_end,actual_end,planned_pstate,actual_pstate\n";
+        }
+        std::string deviationsRunId = "extk-" + std::to_string(workflow->getNumberOfTasks());
+        auto const &slot_names = wrench::SchedulePlan::getSlotNames();
+        auto const &planned_tasks = wms->getSchedulePlan()->getPlannedTasks();
+        for (auto const &deviation : wms->getPlanDeviations())
+        {
+            deviationsFile << deviationsRunId << "," << task_graph_store->tasks[deviation.task_index]->getID() << ","
+                           << slot_names[planned_tasks[deviation.task_index].slot] << "," << deviation.planned_start << ","
+                           << deviation.actual_start << "," << deviation.planned_end << "," << deviation.actual_end << ","
+                           << deviation.planned_pstate << "," << deviation.actual_pstate << "\n";
+        }
+    }
+
+    /* Metrics about the WMS decisions go to a separate long-format file, so that the results file keeps its columns */
+    std::ofstream metricsFile;
+    metricsFile.open(output_dir + "/execution_metrics.csv", std::ios::app);
+    if (!metricsFile.is_open())
+    {
+        std::cerr << "Erro ao abrir o arquivo CSV de métricas!" << std::endl;
+        std::cerr << "Erro do sistema: " << strerror(errno) << std::endl;
+    }
+    if (metricsFile.tellp() == 0)
+    {
+        metricsFile << "run_id,metric,value\n";
+    }
+    std::string metricsRunId = "extk-" + std::to_string(workflow->getNumberOfTasks());
+    std::vector<std::pair<std::string, double>> run_metrics(wms->getMetrics().begin(), wms->getMetrics().end());
+    run_metrics.insert(run_metrics.end(), socket_metrics.begin(), socket_metrics.end());
+    run_metrics.emplace_back("context_factory_" + context_factory, 1);
+    run_metrics.emplace_back("context_stack_size_kib", context_stack_size);
+    run_metrics.emplace_back("context_threads", context_threads);
+    if (context_threads > 1)
+    {
+        run_metrics.emplace_back("context_parallel_threshold", context_parallel_threshold);
+    }
+    if (profiler)
+    {
+        auto counters = profiler->getCounters();
+        run_metrics.insert(run_metrics.end(), counters.begin(), counters.end());
+    }
+    for (auto const &metric : run_metrics)
+    {
+        metricsFile << metricsRunId << "," << metric.first << "," << metric.second << "\n";
+    }
+    metricsFile.close();
+
+    if (results_database)
+    {
+        wrench::ResultsRun run = {metricsRunId, platform_file, workflow_file, workflow->getNumberOfTasks(), num_failed_tasks,
+                                  workflow->getCompletionDate(), 0.0};
+        std::vector<wrench::ResultsHost> hosts;
+        for (auto const &host_name : hostname_list)
+        {
+            run.energy += energy_per_host[host_name];
+            hosts.push_back({host_name, (unsigned long)simulation->getHostNumCores(host_name), energy_per_host[host_name],
+                             energy_per_host[host_name] / run.makespan});
+        }
+        std::vector<wrench::ResultsTask> tasks;
+        tasks.reserve(trace.size());
+        for (const auto &item : trace)
+        {
+            auto task = item->getContent()->getTask();
+            auto execution = task->getExecutionHistory().top();
+            tasks.push_back({task->getID(), execution.physical_execution_host, execution.num_cores_allocated,
+                             execution.task_start, execution.task_end, execution.computation_end - execution.computation_start,
+                             execution.read_input_end - execution.read_input_start,
+                             execution.write_output_end - execution.write_output_start,
+                             task->getExecutionHistory().size() - 1});
+        }
+        try
+        {
+            results_database->insertRun(run, options, hosts, tasks, std::map<std::string, double>(run_metrics.begin(), run_metrics.end()));
+        }
+        catch (std::runtime_error &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+    }
+
+    if (csvFile)
+    {
+        try
+        {
+            csvFile->close();
+        }
+        catch (std::runtime_error &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
 
     return 0;
 }
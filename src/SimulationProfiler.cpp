@@ -0,0 +1,122 @@
+
+#include <algorithm>
+
+#include <simgrid/s4u.hpp>
+
+#include "SimulationProfiler.h"
+
+namespace wrench {
+
+    /**
+     * @brief Connect the counters to the SimGrid signals (once the SimGrid engine exists, and for the
+     *        lifetime of the profiler)
+     */
+    void SimulationProfiler::install() {
+        simgrid::s4u::Actor::on_creation_cb([this](simgrid::s4u::Actor &) {
+            this->actors_created++;
+            this->live_actors++;
+            this->max_live_actors = std::max(this->max_live_actors, this->live_actors);
+        });
+        simgrid::s4u::Actor::on_destruction_cb([this](simgrid::s4u::Actor const &) {
+            // Actors created before the profiler was installed are not counted
+            if (this->live_actors > 0) {
+                this->live_actors--;
+            }
+        });
+        auto started = [this]() {
+            unsigned long pending_comms = this->comms_started - this->comms_completed;
+            unsigned long pending_execs = this->execs_started - this->execs_completed;
+            this->max_pending_comms = std::max(this->max_pending_comms, pending_comms);
+            this->max_pending_activities = std::max(this->max_pending_activities, pending_comms + pending_execs);
+        };
+        simgrid::s4u::Comm::on_start_cb([this, started](simgrid::s4u::Comm const &) {
+            this->comms_started++;
+            started();
+        });
+        simgrid::s4u::Exec::on_start_cb([this, started](simgrid::s4u::Exec const &) {
+            this->execs_started++;
+            started();
+        });
+        simgrid::s4u::Comm::on_completion_cb([this](simgrid::s4u::Comm const &) { this->comms_completed++; });
+        simgrid::s4u::Exec::on_completion_cb([this](simgrid::s4u::Exec const &) { this->execs_completed++; });
+        simgrid::s4u::Engine::on_time_advance_cb([this](double) { this->time_advances++; });
+    }
+
+    /**
+     * @brief Start measuring the wall-clock time of the simulation
+     */
+    void SimulationProfiler::start() {
+        this->start_time = Clock::now();
+    }
+
+    /**
+     * @brief Stop measuring the wall-clock time of the simulation
+     */
+    void SimulationProfiler::stop() {
+        this->wall_time = std::chrono::duration<double>(Clock::now() - this->start_time).count();
+    }
+
+    /**
+     * @brief Get the counters, and the rates derived from them
+     *
+     * @return the counters, by name
+     */
+    std::map<std::string, double> SimulationProfiler::getCounters() const {
+        double wall_time = std::max(this->wall_time, 1e-9);
+        unsigned long activities_completed = this->comms_completed + this->execs_completed;
+        return {{"sim_wall_time", this->wall_time},
+                {"sim_wms_time", this->wms_time},
+                {"sim_kernel_and_services_time", std::max(0.0, this->wall_time - this->wms_time)},
+                {"sim_actors_created", (double) this->actors_created},
+                {"sim_max_live_actors", (double) this->max_live_actors},
+                {"sim_comms_started", (double) this->comms_started},
+                {"sim_execs_started", (double) this->execs_started},
+                {"sim_activities_completed", (double) activities_completed},
+                {"sim_activities_per_second", (double) activities_completed / wall_time},
+                {"sim_max_pending_comms", (double) this->max_pending_comms},
+                {"sim_max_pending_activities", (double) this->max_pending_activities},
+                {"sim_time_advances", (double) this->time_advances},
+                {"sim_wms_events", (double) this->wms_events},
+                {"sim_wms_events_per_second", (double) this->wms_events / wall_time},
+                {"sim_max_ready_tasks", (double) this->max_ready_tasks}};
+    }
+
+    void SimulationProfiler::enterWms() {
+        if (this->wms_depth++ == 0) {
+            this->wms_start_time = Clock::now();
+        }
+    }
+
+    void SimulationProfiler::leaveWms() {
+        if (--this->wms_depth == 0) {
+            this->wms_time += std::chrono::duration<double>(Clock::now() - this->wms_start_time).count();
+        }
+    }
+
+    /**
+     * @brief Stop accounting time to the WMS, whatever the nesting depth
+     *
+     * @return the nesting depth, to be restored
+     */
+    unsigned long SimulationProfiler::suspendWms() {
+        unsigned long depth = this->wms_depth;
+        if (depth > 0) {
+            this->wms_depth = 1;
+            leaveWms();
+        }
+        return depth;
+    }
+
+    /**
+     * @brief Resume accounting time to the WMS
+     *
+     * @param depth: the nesting depth returned by suspendWms()
+     */
+    void SimulationProfiler::resumeWms(unsigned long depth) {
+        if (depth > 0) {
+            enterWms();
+            this->wms_depth = depth;
+        }
+    }
+
+}// namespace wrench
@@ -0,0 +1,163 @@
+
+#include "TaskGraphStore.h"
+
+namespace wrench {
+
+    /**
+     * @brief Constructor, which assigns dense IDs to the tasks and files of a workflow and copies
+     *        their metadata into contiguous arrays
+     *
+     * @param workflow: a workflow
+     */
+    TaskGraphStore::TaskGraphStore(const std::shared_ptr<Workflow> &workflow) {
+        this->tasks = workflow->getTasks();
+        auto num_tasks = this->tasks.size();
+        this->task_indices.reserve(num_tasks);
+        this->task_id_indices.reserve(num_tasks);
+        for (unsigned int i = 0; i < num_tasks; i++) {
+            this->task_indices[this->tasks[i].get()] = i;
+            this->task_id_indices[this->tasks[i]->getID()] = i;
+        }
+
+        auto file_map = workflow->getFileMap();
+        this->files.reserve(file_map.size());
+        this->file_indices.reserve(file_map.size());
+        this->file_sizes.reserve(file_map.size());
+        for (auto const &f: file_map) {
+            this->file_indices[f.second.get()] = this->files.size();
+            this->files.push_back(f.second);
+            this->file_sizes.push_back((double) f.second->getSize());
+        }
+
+        std::unordered_map<std::string, unsigned int> category_indices;
+        this->task_flops.reserve(num_tasks);
+        this->task_input_bytes.reserve(num_tasks);
+        this->task_output_bytes.reserve(num_tasks);
+        this->task_min_cores.reserve(num_tasks);
+        this->task_max_cores.reserve(num_tasks);
+        this->task_categories.reserve(num_tasks);
+        for (auto offsets: {&this->parent_offsets, &this->child_offsets, &this->input_offsets, &this->output_offsets}) {
+            offsets->reserve(num_tasks + 1);
+            offsets->push_back(0);
+        }
+
+        for (auto const &task: this->tasks) {
+            this->task_flops.push_back(task->getFlops());
+            this->task_min_cores.push_back(task->getMinNumCores());
+            this->task_max_cores.push_back(task->getMaxNumCores());
+
+            auto category_name = getCategoryName(task->getID());
+            auto category = category_indices.find(category_name);
+            if (category == category_indices.end()) {
+                category = category_indices.insert({category_name, (unsigned int) this->category_names.size()}).first;
+                this->category_names.push_back(category_name);
+            }
+            this->task_categories.push_back(category->second);
+
+            for (auto const &parent: task->getParents()) {
+                this->parents.push_back(this->task_indices[parent.get()]);
+            }
+            this->parent_offsets.push_back(this->parents.size());
+            for (auto const &child: task->getChildren()) {
+                this->children.push_back(this->task_indices[child.get()]);
+            }
+            this->child_offsets.push_back(this->children.size());
+
+            double input_bytes = 0.0;
+            for (auto const &f: task->getInputFiles()) {
+                this->inputs.push_back(this->file_indices[f.get()]);
+                input_bytes += this->file_sizes[this->inputs.back()];
+            }
+            this->input_offsets.push_back(this->inputs.size());
+            this->task_input_bytes.push_back(input_bytes);
+
+            double output_bytes = 0.0;
+            for (auto const &f: task->getOutputFiles()) {
+                this->outputs.push_back(this->file_indices[f.get()]);
+                output_bytes += this->file_sizes[this->outputs.back()];
+            }
+            this->output_offsets.push_back(this->outputs.size());
+            this->task_output_bytes.push_back(output_bytes);
+        }
+    }
+
+    /**
+     * @brief Get the dense ID of a task
+     *
+     * @param task: a task of the workflow
+     * @return a task index
+     *
+     * @throw std::invalid_argument
+     */
+    unsigned long TaskGraphStore::getTaskIndex(const std::shared_ptr<WorkflowTask> &task) const {
+        auto index = this->task_indices.find(task.get());
+        if (index == this->task_indices.end()) {
+            throw std::invalid_argument("TaskGraphStore::getTaskIndex(): Unknown task " + task->getID());
+        }
+        return index->second;
+    }
+
+    /**
+     * @brief Get the dense ID of a task from its WfCommons ID
+     *
+     * @param task_id: the ID of a task of the workflow
+     * @return a task index
+     *
+     * @throw std::invalid_argument
+     */
+    unsigned long TaskGraphStore::getTaskIndex(const std::string &task_id) const {
+        auto index = this->task_id_indices.find(task_id);
+        if (index == this->task_id_indices.end()) {
+            throw std::invalid_argument("TaskGraphStore::getTaskIndex(): Unknown task " + task_id);
+        }
+        return index->second;
+    }
+
+    /**
+     * @brief Get the dense ID of a file
+     *
+     * @param file: a file of the workflow
+     * @return a file index
+     *
+     * @throw std::invalid_argument
+     */
+    unsigned long TaskGraphStore::getFileIndex(const std::shared_ptr<DataFile> &file) const {
+        auto index = this->file_indices.find(file.get());
+        if (index == this->file_indices.end()) {
+            throw std::invalid_argument("TaskGraphStore::getFileIndex(): Unknown file " + file->getID());
+        }
+        return index->second;
+    }
+
+    /**
+     * @brief Get the index of a task category
+     *
+     * @param category_name: a category name
+     * @return a category index, or -1 if no task has that category
+     */
+    long TaskGraphStore::getCategoryIndex(const std::string &category_name) const {
+        for (unsigned long i = 0; i < this->category_names.size(); i++) {
+            if (this->category_names[i] == category_name) {
+                return (long) i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Get the category of a task, i.e., its WfCommons ID without the trailing task number
+     *        (e.g., "blastall" for "blastall_00000002")
+     *
+     * @param task_id: a task ID
+     * @return the task category
+     */
+    std::string TaskGraphStore::getCategoryName(const std::string &task_id) {
+        auto separator = task_id.find_last_of('_');
+        if (separator == std::string::npos or
+            task_id.find_first_not_of("0123456789", separator + 1) != std::string::npos) {
+            return task_id;
+        }
+        return task_id.substr(0, separator);
+    }
+
+}// namespace wrench
@@ -0,0 +1,147 @@
+
+#include <cmath>
+#include <cstring>
+
+#include "TimelineRecorder.h"
+
+namespace wrench {
+
+    namespace {
+
+        /**
+         * @brief Build the header of a timeline file
+         *
+         * @param hostnames: the host names
+         * @param task_ids: the task IDs
+         * @return the header bytes
+         */
+        std::string timelineHeader(const std::vector<std::string> &hostnames, const std::vector<std::string> &task_ids) {
+            std::string header = "WFTL0001";
+            auto appendU32 = [&header](uint32_t value) { header.append(reinterpret_cast<const char *>(&value), sizeof(value)); };
+            appendU32(hostnames.size());
+            appendU32(task_ids.size());
+            for (auto names: {&hostnames, &task_ids}) {
+                for (auto const &name: *names) {
+                    appendU32(name.size());
+                    header += name;
+                }
+            }
+            header.append((8 - header.size() % 8) % 8, '\0');
+            return header;
+        }
+
+    }// namespace
+
+    /**
+     * @brief Constructor, which opens the timeline file and writes its header
+     *
+     * @param path: the path of the timeline file
+     * @param hostnames: the names of the hosts tasks may run on
+     * @param task_ids: the task IDs, by task index
+     *
+     * @throw std::runtime_error
+     */
+    TimelineRecorder::TimelineRecorder(const std::string &path,
+                                       const std::vector<std::string> &hostnames,
+                                       const std::vector<std::string> &task_ids)
+        : writer(
+                  path,
+                  [](const TimelineRecord &record, std::string &out) {
+                      out.append(reinterpret_cast<const char *>(&record), sizeof(record));
+                  },
+                  false, false, timelineHeader(hostnames, task_ids)),
+          hosts(hostnames.size()) {
+        for (uint32_t i = 0; i < hostnames.size(); i++) {
+            this->host_indices[hostnames[i]] = i;
+        }
+    }
+
+    /**
+     * @brief Record the submission of a task, which cannot start earlier
+     *
+     * @param task_index: the task index
+     * @param date: the submission date
+     */
+    void TimelineRecorder::taskSubmitted(unsigned long task_index, double date) {
+        this->in_flight_tasks[task_index] = this->submission_dates.insert(date);
+    }
+
+    /**
+     * @brief Record the end (completion or failure) of a task, and emit the utilization intervals that
+     *        are now final
+     *
+     * @param task_index: the task index
+     * @param hostname: the host the task ran on
+     * @param num_cores: the number of cores allocated to the task
+     * @param start_date: the date at which the task started
+     * @param end_date: the date at which the task ended
+     * @param failed: whether the task failed
+     */
+    void TimelineRecorder::taskEnded(unsigned long task_index, const std::string &hostname, unsigned long num_cores,
+                                     double start_date, double end_date, bool failed) {
+        auto in_flight_task = this->in_flight_tasks.find(task_index);
+        if (in_flight_task != this->in_flight_tasks.end()) {
+            this->submission_dates.erase(in_flight_task->second);
+            this->in_flight_tasks.erase(in_flight_task);
+        }
+
+        auto host_index = this->host_indices.find(hostname);
+        if (host_index != this->host_indices.end() and start_date >= 0.0 and end_date >= start_date) {
+            TimelineRecord record;
+            record.type = 0;
+            record.failed = failed;
+            record.host_index = host_index->second;
+            record.task_index = task_index;
+            record.num_cores = num_cores;
+            record.start_date = start_date;
+            record.end_date = end_date;
+            this->writer.write(record);
+
+            auto &host = this->hosts[host_index->second];
+            host.changes.push({start_date, (long) num_cores});
+            host.changes.push({end_date, -(long) num_cores});
+        }
+
+        // Tasks still in flight (and tasks to come) cannot start before the earliest submission date
+        emitUtilization(this->submission_dates.empty() ? end_date : *this->submission_dates.begin());
+    }
+
+    /**
+     * @brief Emit the remaining utilization intervals, and close the timeline file
+     *
+     * @throw std::runtime_error
+     */
+    void TimelineRecorder::close() {
+        emitUtilization(INFINITY);
+        this->writer.close();
+    }
+
+    /**
+     * @brief Emit the utilization intervals of all hosts that end before a date
+     *
+     * @param until: a date before which no new utilization change can occur
+     */
+    void TimelineRecorder::emitUtilization(double until) {
+        for (uint32_t i = 0; i < this->hosts.size(); i++) {
+            auto &host = this->hosts[i];
+            while (not host.changes.empty() and host.changes.top().date < until) {
+                auto change = host.changes.top();
+                host.changes.pop();
+                if (change.date > host.interval_start) {
+                    if (host.busy_cores > 0) {
+                        TimelineRecord record;
+                        record.type = 1;
+                        record.host_index = i;
+                        record.num_cores = host.busy_cores;
+                        record.start_date = host.interval_start;
+                        record.end_date = change.date;
+                        this->writer.write(record);
+                    }
+                    host.interval_start = change.date;
+                }
+                host.busy_cores += change.delta;
+            }
+        }
+    }
+
+}// namespace wrench
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifdef ENABLE_SIMDJSON
+#include <simdjson.h>
+#endif
+
+#include "WfFormatLoader.h"
+
+namespace wrench {
+
+    /**
+     * @brief Whether the simulator was built with simdjson, i.e., whether the loader can be used
+     *
+     * @return true or false
+     */
+    bool WfFormatLoader::isAvailable() {
+#ifdef ENABLE_SIMDJSON
+        return true;
+#else
+        return false;
+#endif
+    }
+
+#ifndef ENABLE_SIMDJSON
+
+    /**
+     * @brief Create a workflow from a WfFormat JSON file (unavailable: built without simdjson)
+     *
+     * @throw std::runtime_error
+     */
+    std::shared_ptr<Workflow> WfFormatLoader::createWorkflowFromJSON(const std::string &filename,
+                                                                     const std::string &reference_flop_rate) {
+        throw std::runtime_error("WfFormatLoader::createWorkflowFromJSON(): The simulator was built without simdjson");
+    }
+
+#else
+
+    /**
+     * @brief Create a workflow from a WfFormat 1.5 JSON file
+     *
+     * @param filename: the path of the JSON file
+     * @param reference_flop_rate: the flop rate at which task runtimes were measured (e.g., "100Gf")
+     * @return a workflow
+     *
+     * @throw std::invalid_argument
+     */
+    std::shared_ptr<Workflow> WfFormatLoader::createWorkflowFromJSON(const std::string &filename,
+                                                                     const std::string &reference_flop_rate) {
+        double flop_rate = UnitParser::parse_compute_speed(reference_flop_rate);
+
+        // What the specification says about a task, as views into the parser buffers
+        struct TaskSpecification {
+            std::string_view id;
+            size_t first_parent, first_input, first_output;
+        };
+        // What the execution says about a task
+        struct TaskExecution {
+            double runtime = 0.0;
+            double avg_cpu = -1.0;
+            double read_bytes = -1.0;
+            double written_bytes = -1.0;
+            double memory = 0.0;
+            unsigned long cores = 1;
+        };
+
+        std::vector<TaskSpecification> task_specifications;
+        std::vector<std::string_view> parents, inputs, outputs;
+        std::unordered_map<std::string_view, sg_size_t> file_sizes;
+        std::unordered_map<std::string_view, TaskExecution> task_executions;
+
+        simdjson::ondemand::parser parser;
+        simdjson::padded_string json;
+        try {
+            json = simdjson::padded_string::load(filename);
+            auto document = parser.iterate(json);
+            std::string_view schema_version = document["schemaVersion"].get_string();
+            if (schema_version != "1.5") {
+                throw std::invalid_argument("WfFormatLoader::createWorkflowFromJSON(): Unsupported WfFormat version " +
+                                            std::string(schema_version) + " (only 1.5 is supported)");
+            }
+            auto workflow_object = document["workflow"];
+
+            auto specification = workflow_object["specification"];
+            for (auto task: specification["tasks"].get_array()) {
+                TaskSpecification task_specification{{}, parents.size(), inputs.size(), outputs.size()};
+                for (auto field: task.get_object()) {
+                    std::string_view key = field.unescaped_key();
+                    if (key == "id") {
+                        task_specification.id = field.value().get_string();
+                    } else if (key == "parents") {
+                        for (auto parent: field.value().get_array()) {
+                            parents.push_back(parent.get_string());
+                        }
+                    } else if (key == "inputFiles") {
+                        task_specification.first_input = inputs.size();
+                        for (auto file: field.value().get_array()) {
+                            inputs.push_back(file.get_string());
+                        }
+                    } else if (key == "outputFiles") {
+                        task_specification.first_output = outputs.size();
+                        for (auto file: field.value().get_array()) {
+                            outputs.push_back(file.get_string());
+                        }
+                    }
+                }
+                task_specifications.push_back(task_specification);
+            }
+            for (auto file: specification["files"].get_array()) {
+                std::string_view id;
+                uint64_t size = 0;
+                for (auto field: file.get_object()) {
+                    std::string_view key = field.unescaped_key();
+                    if (key == "id") {
+                        id = field.value().get_string();
+                    } else if (key == "sizeInBytes") {
+                        size = field.value().get_uint64();
+                    }
+                }
+                file_sizes[id] = size;
+            }
+
+            auto execution = workflow_object["execution"];
+            for (auto task: execution["tasks"].get_array()) {
+                std::string_view id;
+                TaskExecution task_execution;
+                for (auto field: task.get_object()) {
+                    std::string_view key = field.unescaped_key();
+                    if (key == "id") {
+                        id = field.value().get_string();
+                    } else if (key == "runtimeInSeconds") {
+                        task_execution.runtime = field.value().get_double();
+                    } else if (key == "avgCPU") {
+                        task_execution.avg_cpu = field.value().get_double();
+                    } else if (key == "readBytes") {
+                        task_execution.read_bytes = field.value().get_double();
+                    } else if (key == "writtenBytes") {
+                        task_execution.written_bytes = field.value().get_double();
+                    } else if (key == "memoryInBytes") {
+                        task_execution.memory = field.value().get_double();
+                    } else if (key == "coreCount") {
+                        task_execution.cores = std::max<uint64_t>(field.value().get_uint64(), 1);
+                    }
+                }
+                task_executions[id] = task_execution;
+            }
+        } catch (simdjson::simdjson_error &e) {
+            throw std::invalid_argument("WfFormatLoader::createWorkflowFromJSON(): Invalid WfFormat file " + filename +
+                                        ": " + e.what());
+        }
+
+        // Build the workflow: files, then tasks and their files, then control dependencies
+        auto workflow = Workflow::createWorkflow();
+        std::unordered_map<std::string_view, std::shared_ptr<DataFile>> files;
+        files.reserve(file_sizes.size());
+        for (auto const &file: file_sizes) {
+            files[file.first] = workflow->addFile(std::string(file.first), file.second);
+        }
+        auto getFile = [&files, &filename](std::string_view id) {
+            auto file = files.find(id);
+            if (file == files.end()) {
+                throw std::invalid_argument("WfFormatLoader::createWorkflowFromJSON(): Unknown file " +
+                                            std::string(id) + " in " + filename);
+            }
+            return file->second;
+        };
+
+        std::unordered_map<std::string_view, std::shared_ptr<WorkflowTask>> tasks;
+        tasks.reserve(task_specifications.size());
+        for (size_t i = 0; i < task_specifications.size(); i++) {
+            auto const &task_specification = task_specifications[i];
+            auto const &task_execution = task_executions[task_specification.id];
+            auto task = workflow->addTask(std::string(task_specification.id), task_execution.runtime * flop_rate,
+                                          task_execution.cores, task_execution.cores, (sg_size_t) task_execution.memory);
+            if (task_execution.avg_cpu >= 0.0) {
+                task->setAverageCPU(task_execution.avg_cpu);
+            }
+            if (task_execution.read_bytes >= 0.0) {
+                task->setBytesRead((unsigned long) task_execution.read_bytes);
+            }
+            if (task_execution.written_bytes >= 0.0) {
+                task->setBytesWritten((unsigned long) task_execution.written_bytes);
+            }
+            auto last_input = (i + 1 < task_specifications.size()) ? task_specifications[i + 1].first_input : inputs.size();
+            for (auto j = task_specification.first_input; j < last_input; j++) {
+                task->addInputFile(getFile(inputs[j]));
+            }
+            auto last_output = (i + 1 < task_specifications.size()) ? task_specifications[i + 1].first_output : outputs.size();
+            for (auto j = task_specification.first_output; j < last_output; j++) {
+                task->addOutputFile(getFile(outputs[j]));
+            }
+            tasks[task_specification.id] = task;
+        }
+
+        for (size_t i = 0; i < task_specifications.size(); i++) {
+            auto child = tasks[task_specifications[i].id];
+            auto last_parent = (i + 1 < task_specifications.size()) ? task_specifications[i + 1].first_parent : parents.size();
+            for (auto j = task_specifications[i].first_parent; j < last_parent; j++) {
+                auto parent = tasks.find(parents[j]);
+                if (parent == tasks.end()) {
+                    throw std::invalid_argument("WfFormatLoader::createWorkflowFromJSON(): Unknown parent task " +
+                                                std::string(parents[j]) + " in " + filename);
+                }
+                workflow->addControlDependency(parent->second, child);
+            }
+        }
+
+        return workflow;
+    }
+
+#endif
+
+}// namespace wrench
@@ -0,0 +1,137 @@
+
+/**
+ * Benchmark of the simdjson-based WfFormatLoader against WRENCH's WfCommonsWorkflowParser:
+ * each recipe given on the command line is loaded with both parsers, and the loading times
+ * are reported along with a consistency check of the resulting workflows (numbers of tasks
+ * and files, total flops and task core counts, which the WfCommons parser is told to enforce).
+ *
+ * Usage: wfformat-loader-benchmark [--repetitions=<n>] <workflow file> [<workflow file>...]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <wrench.h>
+#include <wrench/tools/wfcommons/WfCommonsWorkflowParser.h>
+
+#include "WfFormatLoader.h"
+
+/**
+ * @brief Load a workflow and time it
+ *
+ * @param load: the loading function
+ * @param workflow: where to store the loaded workflow
+ * @return the loading time, in milliseconds
+ */
+template<typename Loader>
+static double timeLoad(Loader load, std::shared_ptr<wrench::Workflow> &workflow)
+{
+    auto start = std::chrono::steady_clock::now();
+    workflow = load();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/**
+ * @brief Sum the flops of the tasks of a workflow
+ *
+ * @param workflow: a workflow
+ * @return a number of flops
+ */
+static double totalFlops(const std::shared_ptr<wrench::Workflow> &workflow)
+{
+    double flops = 0.0;
+    for (auto const &task : workflow->getTasks())
+    {
+        flops += task->getFlops();
+    }
+    return flops;
+}
+
+/**
+ * @brief Sum the core counts of the tasks of a workflow
+ *
+ * @param workflow: a workflow
+ * @return a number of cores
+ */
+static unsigned long totalCores(const std::shared_ptr<wrench::Workflow> &workflow)
+{
+    unsigned long cores = 0;
+    for (auto const &task : workflow->getTasks())
+    {
+        cores += task->getMinNumCores() + task->getMaxNumCores();
+    }
+    return cores;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long repetitions = 3;
+    std::vector<std::string> workflow_files;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg.rfind("--repetitions=", 0) == 0)
+        {
+            repetitions = std::stoul(arg.substr(14));
+        }
+        else
+        {
+            workflow_files.push_back(arg);
+        }
+    }
+
+    if (workflow_files.empty() or repetitions == 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [--repetitions=<n>] <workflow file> [<workflow file>...]" << std::endl;
+        exit(1);
+    }
+
+    if (not wrench::WfFormatLoader::isAvailable())
+    {
+        std::cerr << "Error: this benchmark requires a build with simdjson" << std::endl;
+        exit(1);
+    }
+
+    std::cout << "workflow,num_tasks,wfcommons_ms,simdjson_ms,speedup,consistent" << std::endl;
+    for (auto const &workflow_file : workflow_files)
+    {
+        /* Best of n for each parser; workflows are released between loads, since files are registered globally */
+        double wfcommons_time = INFINITY;
+        double simdjson_time = INFINITY;
+        unsigned long num_tasks = 0;
+        bool consistent = true;
+        for (unsigned long i = 0; i < repetitions; i++)
+        {
+            std::shared_ptr<wrench::Workflow> workflow;
+            wfcommons_time = std::min(wfcommons_time, timeLoad([&]()
+                                                               { return wrench::WfCommonsWorkflowParser::createWorkflowFromJSON(workflow_file, "100Gf", false, false, false, 1, 1, true); },
+                                                               workflow));
+            num_tasks = workflow->getNumberOfTasks();
+            unsigned long num_files = workflow->getFileMap().size();
+            double flops = totalFlops(workflow);
+            unsigned long cores = totalCores(workflow);
+            workflow->clear();
+            workflow = nullptr;
+
+            simdjson_time = std::min(simdjson_time, timeLoad([&]()
+                                                             { return wrench::WfFormatLoader::createWorkflowFromJSON(workflow_file, "100Gf"); },
+                                                             workflow));
+            consistent = consistent and workflow->getNumberOfTasks() == num_tasks and
+                         workflow->getFileMap().size() == num_files and
+                         std::fabs(totalFlops(workflow) - flops) <= 1e-9 * flops and
+                         totalCores(workflow) == cores;
+            workflow->clear();
+        }
+        std::cout << workflow_file << "," << num_tasks << "," << std::fixed << std::setprecision(3)
+                  << wfcommons_time << "," << simdjson_time << "," << wfcommons_time / simdjson_time << ","
+                  << (consistent ? "yes" : "no") << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+    }
+
+    return 0;
+}
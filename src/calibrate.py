@@ -0,0 +1,264 @@
+import argparse
+import concurrent.futures
+import csv
+import itertools
+import math
+import pathlib
+import re
+import shlex
+import subprocess
+import sys
+import tempfile
+
+# Calibrates the simulated platform against measured energy logs (RAPL or IPMI) of recorded workflow runs:
+# the reference flop rate and the I/O bandwidths are searched over a grid, and for each candidate the
+# idle:one-core:all-cores wattage of the CPU nodes is fitted in closed form.
+#
+# The fit relies on the energy of a host being linear in its wattage for a given schedule: with the
+# "basis" platforms 1:1:1, 0:1:1 and 0:0:1, whose energies are E1, E2 and E3, the energy for idle:one:all
+# is idle*E1 + (one-idle)*E2 + (all-one)*E3. Each candidate thus costs three simulations per run (run in
+# parallel), whatever the wattage, as long as the WMS decisions do not depend on the wattage. The best
+# candidate is simulated once more with the fitted wattage to report the actual errors.
+#
+# Some policies make decisions from the wattage: pilot job sizing and power-down of batch nodes (platforms
+# with --sleep-wattage), placement on accelerator nodes, --placement=consolidate and --dvfs=energy. With
+# them, the energy is no longer linear in the wattage, and the basis fit is only a first estimate: each
+# candidate is then simulated with its fitted wattage, and the candidates are ranked by the errors of those
+# simulations (the fitted wattage itself may still be off the best one).
+#
+# Runs file (CSV): recipe,energy_log[,start,end]
+#   energy_log: CSV with columns timestamp,host_name and either power (W, e.g. IPMI samples) or
+#               energy (J, cumulative counters, e.g. RAPL), restricted to [start,end] if given
+
+ROOT = pathlib.Path(__file__).parent.parent
+
+parser = argparse.ArgumentParser(description='Calibrate the platform wattage, reference flop rate and I/O bandwidths '
+                                             'against measured energy logs')
+parser.add_argument('--runs', required=True, help='CSV file of recorded runs (recipe,energy_log[,start,end])')
+parser.add_argument('--flop-rates', default='100Gf', help='comma-separated reference flop rates to try')
+parser.add_argument('--disk-bandwidths', default='100MBps', help='comma-separated storage bandwidths to try')
+parser.add_argument('--link-bandwidths', default='10000MBps', help='comma-separated backbone bandwidths to try')
+parser.add_argument('--prior-wattage', default='50.00:250.00:800.00',
+                    help='idle:one-core:all-cores wattage the fit is regularized towards')
+parser.add_argument('--prior-weight', type=float, default=1e-3,
+                    help='weight of the prior wattage, relative to the squared relative energy errors')
+parser.add_argument('--platform-args', default='', help='extra arguments of generate_apollo_platform.py (e.g. node counts)')
+parser.add_argument('--simulator-args', default='', help='extra simulator arguments (shell syntax), e.g. WMS policies')
+parser.add_argument('--simulated-hosts', default=r'^(Node|CloudNode)\d+$',
+                    help='regular expression of the simulated hosts that correspond to the measured nodes')
+parser.add_argument('--simulator', default=str(ROOT / 'build' / 'my-wrench-simulator'), help='simulator executable')
+parser.add_argument('--jobs', type=int, default=4, help='number of simulations run in parallel')
+parser.add_argument('--output', default=str(ROOT / 'platforms' / 'apollo_2000_calibrated_platform.xml'),
+                    help='path of the calibrated platform file')
+parser.add_argument('--report', default=str(ROOT / 'datas' / 'calibration.csv'), help='path of the per-candidate report')
+args = parser.parse_args()
+
+BASES = ['1:1:1', '0:1:1', '0:0:1']
+
+
+def wattage_dependent_options():
+    """The options with which the WMS decisions depend on the wattage."""
+    platform_args, simulator_args = shlex.split(args.platform_args), shlex.split(args.simulator_args)
+    options = [arg for arg in platform_args if arg.split('=')[0] == '--sleep-wattage']
+    for i, arg in enumerate(platform_args):
+        count = arg.partition('=')[2] if '=' in arg else (platform_args[i + 1] if i + 1 < len(platform_args) else '0')
+        if arg.split('=')[0] == '--accelerator-nodes' and count != '0':
+            options.append('--accelerator-nodes')
+    options += [arg for arg in simulator_args if arg in ('--placement=consolidate', '--dvfs=energy')]
+    return options
+
+
+def measured_energy(log_path, start=None, end=None):
+    """Total energy of the measured nodes over [start,end], in Joules."""
+    samples = {}
+    with open(log_path) as log_file:
+        reader = csv.DictReader(log_file)
+        column = 'power' if 'power' in reader.fieldnames else 'energy'
+        if column not in reader.fieldnames:
+            sys.exit(f'{log_path}: expected a power or energy column')
+        for row in reader:
+            timestamp = float(row['timestamp'])
+            if (start is None or timestamp >= start) and (end is None or timestamp <= end):
+                samples.setdefault(row['host_name'], []).append((timestamp, float(row[column])))
+    energy = 0.0
+    for host_samples in samples.values():
+        host_samples.sort()
+        for (t0, v0), (t1, v1) in zip(host_samples, host_samples[1:]):
+            if column == 'power':
+                energy += (v0 + v1) / 2 * (t1 - t0)
+            elif v1 >= v0:
+                # Cumulative counters: a decrease is a wrap-around, whose interval is skipped
+                energy += v1 - v0
+    return energy
+
+
+def generate_platform(path, wattage, disk_bandwidth, link_bandwidth):
+    subprocess.run([sys.executable, str(ROOT / 'platforms' / 'generate_apollo_platform.py'), '--output', str(path),
+                    '--wattage', wattage, '--disk-read-bandwidth', disk_bandwidth, '--disk-write-bandwidth', disk_bandwidth,
+                    '--link-bandwidth', link_bandwidth] + shlex.split(args.platform_args),
+                   check=True, stdout=subprocess.DEVNULL)
+
+
+def simulated_energy(platform, recipe, flop_rate, work_dir):
+    """Total energy of the simulated hosts matching --simulated-hosts, in Joules."""
+    work_dir.mkdir(parents=True, exist_ok=True)
+    subprocess.run([args.simulator, '--wrench-commport-pool-size=20000', str(platform), recipe, '--wrench-energy-simulation',
+                    f'--reference-flop-rate={flop_rate}', f'--output-dir={work_dir}'] + shlex.split(args.simulator_args),
+                   check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    hosts = re.compile(args.simulated_hosts)
+    energy = 0.0
+    with open(work_dir / 'execution_output.csv') as results_file:
+        for row in csv.DictReader(results_file):
+            if hosts.match(row['host_name']):
+                energy += float(row['power']) * float(row['completion_date'])
+    return energy
+
+
+def solve(matrix, vector):
+    """Solve a small linear system by Gaussian elimination (None if singular)."""
+    n = len(vector)
+    a = [row[:] + [value] for row, value in zip(matrix, vector)]
+    for i in range(n):
+        pivot = max(range(i, n), key=lambda r: abs(a[r][i]))
+        if abs(a[pivot][i]) < 1e-12:
+            return None
+        a[i], a[pivot] = a[pivot], a[i]
+        for r in range(n):
+            if r != i:
+                factor = a[r][i] / a[i][i]
+                a[r] = [x - factor * y for x, y in zip(a[r], a[i])]
+    return [a[i][n] / a[i][i] for i in range(n)]
+
+
+def fit_wattage(features, measurements, prior, weight):
+    """
+    Non-negative least squares of the relative energy error over the increments (idle, one-idle, all-one),
+    regularized towards the prior wattage (which settles the runs that cannot tell the increments apart),
+    by enumerating the sets of free increments (there are only 3). Returns (idle, one, all) and the error.
+    """
+    prior_increments = [prior[0], prior[1] - prior[0], prior[2] - prior[1]]
+    scale = max(prior[2], 1.0)
+    best = None
+    for free in itertools.product([False, True], repeat=3):
+        indices = [i for i in range(3) if free[i]]
+        increments = [0.0, 0.0, 0.0]
+        if indices:
+            rows = [[f[i] / m for i in indices] for f, m in zip(features, measurements)]
+            matrix = [[sum(r[p] * r[q] for r in rows) + (weight / scale ** 2 if p == q else 0.0)
+                       for q in range(len(indices))] for p in range(len(indices))]
+            vector = [sum(r[p] for r in rows) + weight * prior_increments[indices[p]] / scale ** 2
+                      for p in range(len(indices))]
+            solution = solve(matrix, vector)
+            if solution is None or min(solution) < 0.0:
+                continue
+            for i, value in zip(indices, solution):
+                increments[i] = value
+        error = relative_error([sum(x * y for x, y in zip(f, increments)) for f in features], measurements)
+        objective = len(measurements) * error ** 2 + \
+            weight * sum(((x - p) / scale) ** 2 for x, p in zip(increments, prior_increments))
+        if best is None or objective < best[2]:
+            best = (increments, error, objective)
+    idle, one_minus_idle, all_minus_one = best[0]
+    return (idle, idle + one_minus_idle, idle + one_minus_idle + all_minus_one), best[1]
+
+
+def relative_error(simulated, measured):
+    """Root mean square of the relative errors."""
+    return math.sqrt(sum(((s - m) / m) ** 2 for s, m in zip(simulated, measured)) / len(measured))
+
+
+with open(args.runs) as runs_file:
+    runs = list(csv.DictReader(runs_file))
+if not runs:
+    sys.exit(f'No runs in {args.runs}')
+measurements = []
+for run in runs:
+    start = float(run['start']) if run.get('start') else None
+    end = float(run['end']) if run.get('end') else None
+    measurements.append(measured_energy(run['energy_log'], start, end))
+    print(f"Measured {measurements[-1]:.1f} J for {run['recipe']}")
+    if measurements[-1] <= 0.0:
+        sys.exit(f"No measured energy for {run['recipe']}")
+
+nonlinear = wattage_dependent_options()
+if nonlinear:
+    print(f"The WMS decisions depend on the wattage ({', '.join(nonlinear)}): "
+          f"each candidate is checked with a simulation at its fitted wattage")
+
+candidates = list(itertools.product(args.flop_rates.split(','), args.disk_bandwidths.split(','),
+                                    args.link_bandwidths.split(',')))
+report = []
+with tempfile.TemporaryDirectory(prefix='calibration-') as tmp, \
+        concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as executor:
+    tmp = pathlib.Path(tmp)
+    futures = {}
+    for c, (flop_rate, disk_bandwidth, link_bandwidth) in enumerate(candidates):
+        for b, basis in enumerate(BASES):
+            platform = tmp / f'platform-{c}-{b}.xml'
+            generate_platform(platform, basis, disk_bandwidth, link_bandwidth)
+            for r, run in enumerate(runs):
+                futures[(c, b, r)] = executor.submit(simulated_energy, platform, run['recipe'], flop_rate,
+                                                     tmp / f'run-{c}-{b}-{r}')
+
+    for c, candidate in enumerate(candidates):
+        try:
+            features = [[futures[(c, b, r)].result() for b in range(len(BASES))] for r in range(len(runs))]
+        except subprocess.CalledProcessError as e:
+            print(f'Candidate {candidate} failed: {e}')
+            continue
+        wattage, error = fit_wattage(features, measurements, [float(w) for w in args.prior_wattage.split(':')],
+                                     args.prior_weight)
+        report.append((error, candidate, wattage))
+
+    def check(candidate, wattage, name):
+        """The simulated energies of the runs with a fitted wattage."""
+        platform = tmp / f'platform-{name}.xml'
+        generate_platform(platform, ':'.join(f'{w:.2f}' for w in wattage), candidate[1], candidate[2])
+        return [executor.submit(simulated_energy, platform, run['recipe'], candidate[0], tmp / f'{name}-{r}')
+                for r, run in enumerate(runs)]
+
+    # Without linearity, the errors of the fit are replaced by those of actual simulations
+    checked = {}
+    if nonlinear:
+        check_futures = [check(candidate, wattage, f'check-{c}') for c, (_, candidate, wattage) in enumerate(report)]
+        for c, (_, candidate, wattage) in enumerate(report):
+            try:
+                checked[candidate] = [future.result() for future in check_futures[c]]
+            except subprocess.CalledProcessError as e:
+                print(f'Candidate {candidate} failed: {e}')
+                continue
+            report[c] = (relative_error(checked[candidate], measurements), candidate, wattage)
+        report = [entry for entry in report if entry[1] in checked]
+    for error, candidate, wattage in report:
+        print(f'Candidate flop rate {candidate[0]}, disk {candidate[1]}, link {candidate[2]}: '
+              f'wattage {wattage[0]:.2f}:{wattage[1]:.2f}:{wattage[2]:.2f}, relative error {error:.4f}')
+
+    if not report:
+        sys.exit('All candidates failed')
+    error, (flop_rate, disk_bandwidth, link_bandwidth), wattage = min(report)
+
+    # Check the fitted wattage with actual simulations
+    if (flop_rate, disk_bandwidth, link_bandwidth) in checked:
+        checks = checked[(flop_rate, disk_bandwidth, link_bandwidth)]
+    else:
+        checks = [future.result() for future in check((flop_rate, disk_bandwidth, link_bandwidth), wattage, 'check')]
+    wattage = ':'.join(f'{w:.2f}' for w in wattage)
+
+generate_platform(pathlib.Path(args.output), wattage, disk_bandwidth, link_bandwidth)
+
+report_path = pathlib.Path(args.report)
+report_path.parent.mkdir(parents=True, exist_ok=True)
+with open(report_path, 'w', newline='') as report_file:
+    writer = csv.writer(report_file)
+    writer.writerow(['flop_rate', 'disk_bandwidth', 'link_bandwidth', 'idle_watts', 'one_core_watts', 'all_cores_watts',
+                     'relative_error'])
+    for candidate_error, candidate, candidate_wattage in sorted(report):
+        writer.writerow(list(candidate) + [f'{w:.2f}' for w in candidate_wattage] + [f'{candidate_error:.6f}'])
+
+print('')
+for run, measured, simulated in zip(runs, measurements, checks):
+    print(f"{run['recipe']}: measured {measured:.1f} J, simulated {simulated:.1f} J "
+          f"({100 * (simulated - measured) / measured:+.2f}%)")
+print(f'Calibrated wattage {wattage}, flop rate {flop_rate}, disk {disk_bandwidth}, link {link_bandwidth}: '
+      f'relative error {relative_error(checks, measurements):.4f}')
+print(f'Platform written to {args.output}; run the simulator with --reference-flop-rate={flop_rate}')
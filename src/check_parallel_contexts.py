@@ -0,0 +1,73 @@
+import argparse
+import csv
+import pathlib
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+# Checks that parallel actor execution (--context-threads) does not change the simulation results, and
+# measures its speedup: the workflow is simulated sequentially and with each number of threads, several
+# times each, and the result files are compared with those of the first sequential run. The simulated
+# results (execution_output.csv, and execution_metrics.csv without the wall-clock rate counters and the
+# context settings) must be identical; the wall-clock time of each configuration is the median of its runs.
+#
+#   python3 src/check_parallel_contexts.py platforms/apollo_2000_platform.xml workflows/blast/blast-chameleon-large-001.json \
+#       --threads 2,4,8 --repeats 3
+
+ROOT = pathlib.Path(__file__).parent.parent
+
+parser = argparse.ArgumentParser(description='Check the determinism and measure the speedup of parallel actor execution')
+parser.add_argument('platform', help='XML platform file')
+parser.add_argument('workflow', help='workflow file (or recipe key, with --recipe-repository in --simulator-args)')
+parser.add_argument('--threads', default='2,4', help='comma-separated numbers of threads to compare with sequential execution')
+parser.add_argument('--parallel-threshold', help='minimum number of ready actors for a round to run in parallel')
+parser.add_argument('--repeats', type=int, default=3, help='number of runs of each configuration')
+parser.add_argument('--simulator', default=str(ROOT / 'build' / 'my-wrench-simulator'), help='simulator executable')
+parser.add_argument('--simulator-args', default='', help='extra simulator arguments (space-separated)')
+args = parser.parse_args()
+
+# Metrics that legitimately differ between runs
+VOLATILE_METRICS = ('sim_', 'context_')
+
+
+def simulate(threads, output_dir):
+    """Run the simulator, and return its wall-clock time and its simulated results."""
+    output_dir.mkdir(parents=True)
+    command = [args.simulator, '--wrench-commport-pool-size=20000', args.platform, args.workflow, '--wrench-energy-simulation',
+               f'--output-dir={output_dir}', f'--context-threads={threads}'] + args.simulator_args.split()
+    if args.parallel_threshold:
+        command.append(f'--context-parallel-threshold={args.parallel_threshold}')
+    start = time.perf_counter()
+    subprocess.run(command, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    wall_time = time.perf_counter() - start
+    results = (output_dir / 'execution_output.csv').read_text()
+    with open(output_dir / 'execution_metrics.csv') as metrics_file:
+        metrics = sorted((row['metric'], row['value']) for row in csv.DictReader(metrics_file)
+                         if not row['metric'].startswith(VOLATILE_METRICS))
+    return wall_time, (results, metrics)
+
+
+configurations = [1] + [int(t) for t in args.threads.split(',')]
+wall_times = {threads: [] for threads in configurations}
+deterministic = True
+reference = None
+with tempfile.TemporaryDirectory(prefix='parallel-contexts-') as tmp:
+    for repeat in range(args.repeats):
+        for threads in configurations:
+            wall_time, results = simulate(threads, pathlib.Path(tmp) / f'run-{threads}-{repeat}')
+            wall_times[threads].append(wall_time)
+            if reference is None:
+                reference = results
+            elif results != reference:
+                deterministic = False
+                print(f'Run {repeat} with {threads} threads: the results differ from the first sequential run')
+
+sequential_time = statistics.median(wall_times[1])
+for threads in configurations:
+    median_time = statistics.median(wall_times[threads])
+    print(f'{threads} threads: {median_time:.2f} s (median of {args.repeats}), speedup {sequential_time / median_time:.2f}')
+if not deterministic:
+    sys.exit('Parallel actor execution changes the simulation results: keep the actors sequential')
+print('The simulation results are identical for all the runs')
@@ -0,0 +1,311 @@
+import argparse
+import csv
+import math
+import pathlib
+import sqlite3
+import sys
+
+from results_db import read_blocks
+
+# Compares two result sets, e.g. before and after a change of SimpleWMS or of the platform: the runs are
+# paired by workflow and configuration, and the relative differences of makespan, energy (and any other
+# metric of execution_metrics.csv) are tested per group of runs with a paired t-test (with a confidence
+# interval of the mean difference) and a sign test. A difference is significant if its t-test p-value,
+# Holm-corrected over all the tests, is below --alpha, and it is flagged as a regression if the mean
+# relative increase is also above --min-effect (higher is worse for every compared metric). Pairs whose
+# baseline is 0 have no relative difference: those whose candidate is not 0 are counted apart (new_nonzero),
+# and any such increase is flagged as a regression as well. The exit status is 1 if there is any regression,
+# and 2 on errors (e.g., no paired runs).
+#
+# A result set is a SQLite database of src/results_db.py, or CSV result files (execution_output.csv and
+# execution_metrics.csv, or the directory containing them). In a database, the runs are paired by workflow
+# and simulator options (--baseline-param/--candidate-param select the runs of each set in a shared
+# database, and the selecting options are not part of the configuration); in CSV files, which do not record
+# them, the k-th run with a run ID is paired with the k-th run with the same run ID, i.e. both sweeps must
+# have run the same recipes in the same order. The runs are aggregated as they are read: only the
+# baseline runs are kept in memory, and the candidate runs are streamed against them.
+#
+#   python3 src/compare_results.py datas/before datas/after --metrics pilot_node_wake_ups
+#   python3 src/compare_results.py datas/results.sqlite datas/results.sqlite \
+#       --baseline-param placement=first-fit --candidate-param placement=consolidate --group-by family
+
+# Simulator options that do not change the simulated results
+IGNORED_PARAMETERS = ['queue_run', 'output-dir', 'results-db', 'decision-log', 'policy-fds', 'profile-simulation',
+                      'trace', 'trace-compression', 'timeline', 'context-factory', 'context-stack-size', 'context-threads',
+                      'context-parallel-threshold', 'workflow-loader', 'recipe-repository']
+
+parser = argparse.ArgumentParser(description='Compare the makespan and energy of two result sets with paired statistical tests')
+parser.add_argument('baseline', help='SQLite results database, or CSV result files (or their directory)')
+parser.add_argument('candidate', help='SQLite results database, or CSV result files (or their directory)')
+parser.add_argument('--baseline-param', action='append', default=[], metavar='NAME=VALUE',
+                    help='only the database runs with this simulator option (repeatable)')
+parser.add_argument('--candidate-param', action='append', default=[], metavar='NAME=VALUE',
+                    help='only the database runs with this simulator option (repeatable)')
+parser.add_argument('--ignore-parameters', default='', help='comma-separated simulator options left out of the configuration')
+parser.add_argument('--metrics', default='', help='comma-separated metrics of execution_metrics.csv to compare as well')
+parser.add_argument('--group-by', choices=['none', 'num_tasks', 'family', 'workflow'], default='num_tasks',
+                    help='groups of runs that are tested separately (all the runs are also tested together)')
+parser.add_argument('--alpha', type=float, default=0.05, help='significance level, over all the tests')
+parser.add_argument('--confidence', type=float, default=0.95, help='level of the confidence intervals')
+parser.add_argument('--min-effect', type=float, default=0.01, help='smallest relative increase flagged as a regression')
+parser.add_argument('--output', help='CSV file of the comparison of each group and metric')
+args = parser.parse_args()
+
+metric_names = ['makespan', 'energy'] + [name for name in args.metrics.split(',') if name]
+
+
+def is_database(path):
+    path = pathlib.Path(path)
+    if not path.is_file():
+        return False
+    with open(path, 'rb') as database_file:
+        return database_file.read(16) == b'SQLite format 3\x00'
+
+
+def read_csv_runs(path):
+    """Yield the (key, group, values) of the runs of CSV result files."""
+    path = pathlib.Path(path)
+    output_file = path / 'execution_output.csv' if path.is_dir() else path
+    metrics_file = output_file.with_name('execution_metrics.csv')
+    compared_metrics = set(metric_names[2:])
+    metric_blocks = read_blocks(metrics_file, 'metric', ['metric', 'value']) if compared_metrics else iter(())
+    occurrences = {}
+    for host_rows in read_blocks(output_file, 'host_name', ['run_id', 'num_of_tasks', 'completion_date', 'power'],
+                                 ['completion_date']):
+        run_id, num_tasks, completion_date = host_rows[0][:3]
+        values = {'makespan': float(completion_date),
+                  'energy': sum(float(power) * float(date) for _, _, date, power in host_rows)}
+        if compared_metrics:
+            values.update((name, float(value)) for name, value in next(metric_blocks, []) if name in compared_metrics)
+        occurrences[run_id] = occurrences.get(run_id, 0) + 1
+        groups = {'none': '', 'num_tasks': num_tasks, 'family': run_id, 'workflow': run_id}
+        yield (run_id, occurrences[run_id]), groups[args.group_by], values
+
+
+def workflow_family(workflow):
+    """blast for blast/100/0 (recipe key) or workflows/blast/blast-chameleon-large-001.json (workflow file)."""
+    parts = pathlib.PurePath(workflow).parts
+    return parts[0] if not workflow.endswith('.json') else (parts[-2] if len(parts) > 1 else pathlib.PurePath(workflow).stem)
+
+
+def read_database_runs(path, selected_parameters):
+    """Yield the (key, group, values) of the runs of a results database that have the selected options."""
+    selected = dict(parameter.split('=', 1) for parameter in selected_parameters)
+    ignored = set(IGNORED_PARAMETERS + [name for name in args.ignore_parameters.split(',') if name])
+    ignored.update(name for parameters in (args.baseline_param, args.candidate_param)
+                   for name in (parameter.split('=', 1)[0] for parameter in parameters))
+    connection = sqlite3.connect(f'file:{path}?mode=ro', uri=True, timeout=60.0)
+    # One pass over the runs: the options and metrics of each run are read through the run_key indexes
+    metric_columns = ''.join(f', (SELECT value FROM metrics m WHERE m.run_key = r.run_key AND m.name = ?)'
+                             for _ in metric_names[2:])
+    conditions = ''.join(' AND EXISTS (SELECT 1 FROM parameters p WHERE p.run_key = r.run_key AND p.name = ? AND p.value = ?)'
+                         for _ in selected)
+    sql = (f"SELECT r.workflow, r.num_tasks, r.makespan, r.energy, (SELECT group_concat(p.name || '=' || p.value, char(31)) "
+           f"FROM parameters p WHERE p.run_key = r.run_key){metric_columns} FROM runs r WHERE 1{conditions} ORDER BY r.run_key")
+    bindings = metric_names[2:] + [item for parameter in selected.items() for item in parameter]
+    occurrences = {}
+    for row in connection.execute(sql, bindings):
+        workflow, num_tasks = row[0] or '', row[1]
+        options = sorted(option for option in (row[4] or '').split('\x1f')
+                         if option and option.split('=', 1)[0] not in ignored)
+        configuration = (workflow, tuple(options))
+        occurrences[configuration] = occurrences.get(configuration, 0) + 1
+        values = {'makespan': row[2], 'energy': row[3]}
+        values.update((name, value) for name, value in zip(metric_names[2:], row[5:]) if value is not None)
+        groups = {'none': '', 'num_tasks': str(num_tasks), 'family': workflow_family(workflow), 'workflow': workflow}
+        yield configuration + (occurrences[configuration],), groups[args.group_by], values
+    connection.close()
+
+
+def fail(message):
+    """Exit with the error status, which is distinct from the one of regressions."""
+    print(f'Error: {message}', file=sys.stderr)
+    sys.exit(2)
+
+
+def read_runs(path, selected_parameters):
+    if is_database(path):
+        return read_database_runs(path, selected_parameters)
+    if selected_parameters:
+        fail(f'{path} has CSV result files, which do not record the simulator options')
+    return read_csv_runs(path)
+
+
+class PairedDifferences:
+    """Running statistics of the relative differences between paired runs (Welford's algorithm); the pairs whose
+    baseline is 0 and candidate is not are only counted."""
+
+    def __init__(self):
+        self.pairs = 0
+        self.new_nonzero = 0
+        self.new_increases = 0
+        self.n = 0
+        self.mean = 0.0
+        self.m2 = 0.0
+        self.baseline_sum = 0.0
+        self.candidate_sum = 0.0
+        self.increases = 0
+        self.decreases = 0
+
+    def add(self, baseline, candidate):
+        self.pairs += 1
+        self.baseline_sum += baseline
+        self.candidate_sum += candidate
+        self.increases += candidate > baseline
+        self.decreases += candidate < baseline
+        if baseline == 0 and candidate != 0:
+            self.new_nonzero += 1
+            self.new_increases += candidate > 0
+            return
+        difference = (candidate - baseline) / abs(baseline) if baseline != 0 else 0.0
+        self.n += 1
+        delta = difference - self.mean
+        self.mean += delta / self.n
+        self.m2 += delta * (difference - self.mean)
+
+
+def incomplete_beta(a, b, x):
+    """Regularized incomplete beta function I_x(a, b), by its continued fraction (modified Lentz's method)."""
+    if x <= 0.0:
+        return 0.0
+    if x >= 1.0:
+        return 1.0
+    if x > (a + 1.0) / (a + b + 2.0):
+        return 1.0 - incomplete_beta(b, a, 1.0 - x)
+    front = math.exp(math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b) + a * math.log(x) + b * math.log(1.0 - x)) / a
+    tiny = 1e-300
+    c, d = 1.0, 1.0 - (a + b) * x / (a + 1.0)
+    d = 1.0 / (d if abs(d) > tiny else tiny)
+    result = d
+    for m in range(1, 300):
+        for numerator in (m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m)),
+                          -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1))):
+            d = 1.0 + numerator * d
+            d = 1.0 / (d if abs(d) > tiny else tiny)
+            c = 1.0 + numerator / c
+            c = c if abs(c) > tiny else tiny
+            result *= c * d
+        if abs(c * d - 1.0) < 1e-15:
+            break
+    return front * result
+
+
+def t_test_p_value(t, df):
+    """Two-sided p-value of Student's t distribution."""
+    return incomplete_beta(df / 2.0, 0.5, df / (df + t * t))
+
+
+def t_quantile(p_value, df):
+    """The t such that the two-sided p-value is p_value, by bisection."""
+    low, high = 0.0, 1e6
+    for _ in range(200):
+        middle = (low + high) / 2.0
+        if t_test_p_value(middle, df) > p_value:
+            low = middle
+        else:
+            high = middle
+    return (low + high) / 2.0
+
+
+def sign_test_p_value(increases, decreases):
+    """Two-sided p-value of the sign test (exact binomial, normal approximation for many pairs)."""
+    n, k = increases + decreases, min(increases, decreases)
+    if n == 0:
+        return 1.0
+    if n > 1000:
+        z = (abs(increases - decreases) - 1.0) / math.sqrt(n)
+        return min(1.0, math.erfc(max(z, 0.0) / math.sqrt(2.0)))
+    tail = sum(math.exp(math.lgamma(n + 1) - math.lgamma(i + 1) - math.lgamma(n - i + 1) - n * math.log(2.0)) for i in range(k + 1))
+    return min(1.0, 2.0 * tail)
+
+
+def test(differences):
+    """The t-test p-value and confidence interval of the mean relative difference (None with fewer than 2 pairs)."""
+    if differences.n < 2:
+        return None, None, None
+    df = differences.n - 1
+    standard_error = math.sqrt(differences.m2 / df / differences.n)
+    if standard_error < 1e-12 * max(1.0, abs(differences.mean)):
+        # Deterministic runs: every pair differs by the same amount
+        return (1.0 if differences.mean == 0 else 0.0), differences.mean, differences.mean
+    p_value = t_test_p_value(differences.mean / standard_error, df)
+    margin = t_quantile(1.0 - args.confidence, df) * standard_error
+    return p_value, differences.mean - margin, differences.mean + margin
+
+
+# The baseline runs are kept by configuration, and each candidate run is compared with its pair as it is read
+baseline_runs = {}
+for key, group, values in read_runs(args.baseline, args.baseline_param):
+    baseline_runs[key] = (group, values)
+statistics = {}
+unmatched_candidates = 0
+for key, group, values in read_runs(args.candidate, args.candidate_param):
+    baseline = baseline_runs.pop(key, None)
+    if baseline is None:
+        unmatched_candidates += 1
+        continue
+    for name in metric_names:
+        if name in values and name in baseline[1]:
+            for group_name in {'all', baseline[0]} if args.group_by != 'none' else {'all'}:
+                statistics.setdefault((group_name, name), PairedDifferences()).add(baseline[1][name], values[name])
+if unmatched_candidates or baseline_runs:
+    print(f'{len(baseline_runs)} baseline runs and {unmatched_candidates} candidate runs have no pair')
+if not statistics:
+    fail('no paired runs to compare')
+
+
+def group_order(group):
+    return (group != 'all', (0, int(group)) if group.isdigit() else (1, group))
+
+
+rows = []
+for (group, name), differences in sorted(statistics.items(), key=lambda item: (group_order(item[0][0]), metric_names.index(item[0][1]))):
+    p_value, ci_low, ci_high = test(differences)
+    rows.append({'group': group, 'metric': name, 'pairs': differences.pairs, 'new_nonzero': differences.new_nonzero,
+                 'baseline_mean': differences.baseline_sum / differences.pairs,
+                 'candidate_mean': differences.candidate_sum / differences.pairs,
+                 'mean_relative_difference': differences.mean if differences.n else None, 'ci_low': ci_low, 'ci_high': ci_high,
+                 't_test_p_value': p_value, 'sign_test_p_value': sign_test_p_value(differences.increases, differences.decreases),
+                 'adjusted_p_value': None, 'verdict': 'too few pairs' if p_value is None else 'no significant change'})
+
+# Holm's step-down correction over all the tests
+tested = sorted((row for row in rows if row['t_test_p_value'] is not None), key=lambda row: row['t_test_p_value'])
+adjusted = 0.0
+for rank, row in enumerate(tested):
+    adjusted = max(adjusted, min(1.0, (len(tested) - rank) * row['t_test_p_value']))
+    row['adjusted_p_value'] = adjusted
+    if adjusted < args.alpha:
+        if row['mean_relative_difference'] > args.min_effect:
+            row['verdict'] = 'REGRESSION'
+        elif row['mean_relative_difference'] < -args.min_effect:
+            row['verdict'] = 'improvement'
+        else:
+            row['verdict'] = 'significant, below --min-effect'
+
+# A metric that was 0 in the baseline and grows in the candidate (e.g., failures) has no relative difference
+for row in rows:
+    if statistics[(row['group'], row['metric'])].new_increases:
+        row['verdict'] = 'REGRESSION'
+
+
+def percent(value):
+    return 'n/a' if value is None else f'{100.0 * value:+.2f}%'
+
+
+print(f"{'group':<14} {'metric':<24} {'pairs':>7} {'new>0':>6} {'baseline':>12} {'candidate':>12} {'difference':>10}  "
+      f"{int(100 * args.confidence)}% interval        {'p (adj.)':>9}  verdict")
+for row in rows:
+    interval = f'[{percent(row["ci_low"])}, {percent(row["ci_high"])}]'
+    adjusted_p = 'n/a' if row['adjusted_p_value'] is None else f'{row["adjusted_p_value"]:.2g}'
+    print(f"{row['group']:<14} {row['metric']:<24} {row['pairs']:>7} {row['new_nonzero']:>6} {row['baseline_mean']:>12.6g} {row['candidate_mean']:>12.6g} "
+          f"{percent(row['mean_relative_difference']):>10}  {interval:<22} {adjusted_p:>9}  {row['verdict']}")
+
+if args.output:
+    with open(args.output, 'w', newline='') as output_file:
+        writer = csv.DictWriter(output_file, fieldnames=list(rows[0]))
+        writer.writeheader()
+        writer.writerows(rows)
+
+regressions = [row for row in rows if row['verdict'] == 'REGRESSION']
+if regressions:
+    sys.exit(f'{len(regressions)} significant regressions')
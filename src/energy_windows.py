@@ -0,0 +1,77 @@
+import argparse
+import bisect
+import csv
+import math
+import pathlib
+
+# Computes the energy, average and peak power, and power histogram of each host over time windows from the
+# per-host power timelines written by the simulator with --power-timelines (power_timelines.csv), so that
+# new windows do not require simulating again. The output files have the format of those written by the
+# simulator with --energy-windows (energy_windows.csv and power_histogram.csv); the power bins span
+# [0, --max-power], the highest power of the timelines by default (the simulator uses the highest
+# all-cores power of the platform).
+#
+#   python3 src/energy_windows.py datas/power_timelines.csv --windows 0:3600,3600:7200 --output-dir datas/windows
+
+ROOT = pathlib.Path(__file__).parent.parent
+
+parser = argparse.ArgumentParser(description='Compute energy and power figures over time windows from power timelines')
+parser.add_argument('timelines', help='power_timelines.csv written by the simulator with --power-timelines')
+parser.add_argument('--windows', required=True, help='<start>:<end>[,<start>:<end>...], in seconds')
+parser.add_argument('--bins', type=int, default=10, help='number of power histogram bins')
+parser.add_argument('--max-power', type=float, help='upper edge of the power histogram, in Watts')
+parser.add_argument('--run-id', help='only the timelines of this run ID')
+parser.add_argument('--output-dir', default=str(ROOT / 'datas'), help='directory of energy_windows.csv and power_histogram.csv')
+args = parser.parse_args()
+
+try:
+    windows = [tuple(float(date) for date in window.split(':')) for window in args.windows.split(',')]
+    # As in the simulator (--energy-windows)
+    if any(len(window) != 2 or not (0.0 <= window[0] < math.inf) or not (window[1] >= window[0]) for window in windows):
+        raise ValueError
+except ValueError:
+    parser.error(f'invalid --windows: {args.windows}')
+
+# The segments of each timeline, in file order: the timeline of a host starts at date 0 in each run, which
+# separates the runs that have the same run ID
+timelines = {}
+occurrences = {}
+with open(args.timelines) as timelines_file:
+    for row in csv.DictReader(timelines_file):
+        if args.run_id is None or row['run_id'] == args.run_id:
+            host = (row['run_id'], row['host_name'])
+            start_date = float(row['start_date'])
+            if start_date == 0.0:
+                occurrences[host] = occurrences.get(host, 0) + 1
+            timelines.setdefault(host + (occurrences.get(host, 1),), []).append(
+                (start_date, float(row['end_date']), float(row['power'])))
+
+max_power = args.max_power if args.max_power is not None else max(
+    (power for segments in timelines.values() for _, _, power in segments), default=0.0)
+edges = [max_power * bin / args.bins for bin in range(args.bins + 1)]
+
+output_dir = pathlib.Path(args.output_dir)
+output_dir.mkdir(parents=True, exist_ok=True)
+with open(output_dir / 'energy_windows.csv', 'w', newline='') as windows_file, \
+        open(output_dir / 'power_histogram.csv', 'w', newline='') as histogram_file:
+    windows_writer = csv.writer(windows_file)
+    histogram_writer = csv.writer(histogram_file)
+    windows_writer.writerow(['run_id', 'host_name', 'window_start', 'window_end', 'energy', 'average_power', 'peak_power'])
+    histogram_writer.writerow(['run_id', 'host_name', 'window_start', 'window_end', 'power_low', 'power_high', 'seconds'])
+    for (run_id, host_name, _), segments in timelines.items():
+        for window_start, window_end in windows:
+            energy, peak_power, histogram = 0.0, 0.0, [0.0] * args.bins
+            for start_date, end_date, power in segments:
+                overlap = min(end_date, window_end) - max(start_date, window_start)
+                if overlap <= 0.0:
+                    continue
+                energy += power * overlap
+                peak_power = max(peak_power, power)
+                if args.bins > 0:
+                    histogram[min(max(bisect.bisect_right(edges, power) - 1, 0), args.bins - 1)] += overlap
+            length = window_end - window_start
+            windows_writer.writerow([run_id, host_name, window_start, window_end, energy,
+                                     energy / length if length > 0.0 else 0.0, peak_power])
+            for bin in range(args.bins):
+                histogram_writer.writerow([run_id, host_name, window_start, window_end, edges[bin], edges[bin + 1], histogram[bin]])
+print(f'Energy of {len(timelines)} host timelines over {len(windows)} windows written to {output_dir}')
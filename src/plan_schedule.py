@@ -0,0 +1,179 @@
+import argparse
+import heapq
+import json
+import pathlib
+import re
+import xml.etree.ElementTree as ElementTree
+
+# Offline static scheduler: computes a HEFT-like plan of a workflow on the compute service slots of
+# SimpleWMS (three cloud VMs, a pilot job on the first batch nodes and the accelerator nodes, if any),
+# written in the format of include/SchedulePlan.h, for my-wrench-simulator --schedule-plan=<plan file>.
+#
+# Tasks are taken by decreasing upward rank (the longest path to an exit task, in mean CPU runtimes), and
+# each one goes to the slot where it finishes the earliest, on the cores of the slot that are free first (as
+# many as the coreCount of its recipe execution, 1 by default, over which its runtime is divided).
+# I/O times and the pilot job walltime are not modeled: the simulator reports how far the execution
+# deviates from the plan in plan_deviations.csv.
+
+ROOT = pathlib.Path(__file__).parent.parent
+
+parser = argparse.ArgumentParser(description='Compute a static schedule plan of a workflow for SimpleWMS')
+parser.add_argument('platform', help='XML platform file')
+parser.add_argument('workflow', help='WfFormat workflow file')
+parser.add_argument('--reference-flop-rate', default='100Gf', help='flop rate of the recorded task runtimes')
+parser.add_argument('--pstate', type=int, default=0, help='pstate of the CPU hosts')
+parser.add_argument('--pilot-nodes', type=int, default=6, help='number of batch nodes of the pilot job (0 for none)')
+parser.add_argument('--pilot-start', type=float, default=0.0, help='date at which the pilot job is expected to start')
+parser.add_argument('--accelerator-speedups', default='',
+                    help='<category>:<speedup>[,<category>:<speedup>...], the task categories the accelerator nodes run')
+parser.add_argument('--output', help='plan file (default: datas/<workflow name>.plan.csv)')
+args = parser.parse_args()
+
+UNITS = {'': 1, 'k': 1e3, 'M': 1e6, 'G': 1e9, 'T': 1e12, 'P': 1e15}
+
+
+def parse_speed(speed):
+    """Parse a SimGrid compute speed, e.g. '100Gf'."""
+    match = re.fullmatch(r'\s*([0-9.eE+-]+)\s*([kMGTP]?)f?\s*', speed)
+    if not match:
+        raise ValueError(f'invalid compute speed {speed!r}')
+    return float(match.group(1)) * UNITS[match.group(2)]
+
+
+def category_name(task_id):
+    """The category of a task, as in TaskGraphStore::getCategoryName()."""
+    name, separator, suffix = task_id.rpartition('_')
+    return name if separator and suffix.isdigit() else task_id
+
+
+class Slot:
+    def __init__(self, name, hosts, speed, available=0.0):
+        self.name = name
+        self.speed = speed
+        # One entry per core: the date at which the core is free
+        self.cores = [available] * sum(cores for _, cores in hosts)
+        heapq.heapify(self.cores)
+
+
+def load_hosts(platform):
+    hosts = {}
+    for host in ElementTree.parse(platform).iter('host'):
+        props = {prop.get('id'): prop.get('value') for prop in host.iter('prop')}
+        hosts[host.get('id')] = {'speeds': [parse_speed(s) for s in host.get('speed').split(',')],
+                                 'cores': int(host.get('core', '1')), 'node_class': props.get('node_class'),
+                                 'sleep_pstate': int(props['sleep_pstate']) if 'sleep_pstate' in props else None}
+    return hosts
+
+
+def host_speed(host, name):
+    if args.pstate >= len(host['speeds']) or args.pstate == host['sleep_pstate']:
+        raise SystemExit(f'pstate {args.pstate} is not a DVFS level of host {name}')
+    return host['speeds'][args.pstate]
+
+
+def build_slots(hosts):
+    slots = []
+    for i in range(1, 4):
+        name = f'CloudNode{i}'
+        slots.append(Slot(f'vm{i}', [(name, 28)], host_speed(hosts[name], name)))
+    batch_nodes = sorted((h for h in hosts if re.fullmatch(r'Node\d+', h)), key=lambda h: int(h[4:]))[:args.pilot_nodes]
+    if batch_nodes:
+        slots.append(Slot('pilot', [(h, hosts[h]['cores']) for h in batch_nodes],
+                          host_speed(hosts[batch_nodes[0]], batch_nodes[0]), args.pilot_start))
+    accelerator_nodes = [h for h in hosts if hosts[h]['node_class'] == 'accelerator']
+    if accelerator_nodes:
+        # The pstates of the accelerator nodes are not managed: they run in their first pstate
+        slots.append(Slot('accelerator', [(h, hosts[h]['cores']) for h in accelerator_nodes],
+                          hosts[accelerator_nodes[0]]['speeds'][0]))
+    return slots
+
+
+def load_workflow(path):
+    document = json.loads(pathlib.Path(path).read_text())
+    runtimes = {t['id']: t.get('runtimeInSeconds', 0.0) for t in document['workflow']['execution']['tasks']}
+    core_counts = {t['id']: max(int(t.get('coreCount', 1)), 1) for t in document['workflow']['execution']['tasks']}
+    flop_rate = parse_speed(args.reference_flop_rate)
+    tasks = {}
+    for task in document['workflow']['specification']['tasks']:
+        tasks[task['id']] = {'flops': runtimes.get(task['id'], 0.0) * flop_rate, 'cores': core_counts.get(task['id'], 1),
+                             'parents': task.get('parents', []), 'children': [], 'category': category_name(task['id'])}
+    for task_id, task in tasks.items():
+        for parent in task['parents']:
+            tasks[parent]['children'].append(task_id)
+    return tasks
+
+
+def topological_order(tasks):
+    num_parents = {task_id: len(task['parents']) for task_id, task in tasks.items()}
+    ready = [task_id for task_id, count in num_parents.items() if count == 0]
+    order = []
+    while ready:
+        task_id = ready.pop()
+        order.append(task_id)
+        for child in tasks[task_id]['children']:
+            num_parents[child] -= 1
+            if num_parents[child] == 0:
+                ready.append(child)
+    if len(order) != len(tasks):
+        raise SystemExit('the workflow has a dependency cycle')
+    return order
+
+
+def plan(tasks, slots):
+    speedups = {}
+    for entry in filter(None, args.accelerator_speedups.split(',')):
+        category, speedup = entry.split(':')
+        speedups[category] = float(speedup)
+    cpu_slots = [s for s in slots if s.name != 'accelerator']
+    cpu_reference_speed = cpu_slots[0].speed
+    mean_cpu_speed = sum(s.speed for s in cpu_slots) / len(cpu_slots)
+
+    def runtime(task, slot):
+        if slot.name != 'accelerator':
+            return task['flops'] / (slot.speed * task['cores'])
+        # Accelerator slots run at most at their host speed, as in SimpleWMS
+        return task['flops'] / (min(slot.speed, cpu_reference_speed * speedups[task['category']]) * task['cores'])
+
+    order = topological_order(tasks)
+    position = {task_id: i for i, task_id in enumerate(order)}
+    rank = {}
+    for task_id in reversed(order):
+        task = tasks[task_id]
+        rank[task_id] = task['flops'] / (mean_cpu_speed * task['cores']) + max((rank[c] for c in task['children']), default=0.0)
+
+    # Ties in rank (zero-flop tasks) are broken in topological order, so that parents are planned first
+    entries = {}
+    for task_id in sorted(tasks, key=lambda t: (-rank[t], position[t])):
+        task = tasks[task_id]
+        ready = max((entries[p][2] for p in task['parents']), default=0.0)
+        best = None
+        for slot in slots:
+            if (slot.name == 'accelerator' and speedups.get(task['category'], 0.0) <= 0.0) or task['cores'] > len(slot.cores):
+                continue
+            start = max(ready, heapq.nsmallest(task['cores'], slot.cores)[-1])
+            end = start + runtime(task, slot)
+            if best is None or end < best[2]:
+                best = (slot, start, end)
+        if best is None:
+            raise SystemExit(f'no slot has the {task["cores"]} cores of task {task_id}')
+        slot, start, end = best
+        for _ in range(task['cores']):
+            heapq.heapreplace(slot.cores, end)
+        entries[task_id] = best
+    return entries
+
+
+tasks = load_workflow(args.workflow)
+slots = build_slots(load_hosts(args.platform))
+entries = plan(tasks, slots)
+
+output = pathlib.Path(args.output) if args.output else ROOT / 'datas' / (pathlib.Path(args.workflow).stem + '.plan.csv')
+output.parent.mkdir(parents=True, exist_ok=True)
+with open(output, 'w') as f:
+    f.write('task_id,service,num_cores,pstate,order,planned_start,planned_end\n')
+    # Tasks start in the order of their planned start on each slot
+    for order, (task_id, (slot, start, end)) in enumerate(sorted(entries.items(), key=lambda e: (e[1][1], e[1][2]))):
+        pstate = 0 if slot.name == 'accelerator' else args.pstate
+        f.write(f'{task_id},{slot.name},{tasks[task_id]["cores"]},{pstate},{order},{start!r},{end!r}\n')
+makespan = max((end for _, _, end in entries.values()), default=0.0)
+print(f'{len(entries)} tasks planned on {", ".join(s.name for s in slots)}: makespan {makespan:.2f} s -> {output}')
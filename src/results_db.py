@@ -0,0 +1,193 @@
+import argparse
+import csv
+import hashlib
+import json
+import pathlib
+import sqlite3
+import sys
+import time
+
+# Embedded SQLite database of simulation results, with indexed tables of runs, parameters (simulator options),
+# hosts, tasks and metrics. The simulator inserts each run itself with --results-db=<database> (when built
+# with SQLite, see include/ResultsDatabase.h); this script imports the CSV result files of past runs or of a
+# sweep queue (src/sweep_queue.py), and queries the database:
+#
+#   python3 src/results_db.py import datas/results.sqlite datas
+#   python3 src/results_db.py import datas/results.sqlite --queue /shared/sweep
+#   python3 src/results_db.py query datas/results.sqlite "SELECT workflow, makespan, energy FROM runs WHERE num_tasks > 1000"
+#
+# The CSV files do not delimit the runs: a run is a block of rows with the same run_id in which no host (or
+# metric) appears twice (and, in execution_output.csv, all the hosts have the same completion date), and the
+# metrics of the k-th run of execution_metrics.csv go to the k-th run of execution_output.csv if both have
+# the same run ID. The CSV files have no task rows. Each imported block is recorded with the csv_import
+# parameter (file, block number and checksum of its rows), so that importing a directory again only imports
+# the runs appended to it since.
+
+# Keep in sync with the schema of src/ResultsDatabase.cpp
+SCHEMA = '''
+CREATE TABLE IF NOT EXISTS runs (run_key INTEGER PRIMARY KEY, run_id TEXT, created REAL, platform TEXT,
+    workflow TEXT, num_tasks INTEGER, tasks_failed INTEGER, makespan REAL, energy REAL);
+CREATE TABLE IF NOT EXISTS parameters (run_key INTEGER REFERENCES runs (run_key), name TEXT, value TEXT);
+CREATE TABLE IF NOT EXISTS hosts (run_key INTEGER REFERENCES runs (run_key), host_name TEXT, num_cores INTEGER,
+    energy REAL, power REAL);
+CREATE TABLE IF NOT EXISTS tasks (run_key INTEGER REFERENCES runs (run_key), task_id TEXT, host_name TEXT,
+    num_cores INTEGER, start_date REAL, end_date REAL, compute_time REAL, io_input_time REAL, io_output_time REAL,
+    failures INTEGER);
+CREATE TABLE IF NOT EXISTS metrics (run_key INTEGER REFERENCES runs (run_key), name TEXT, value REAL);
+CREATE INDEX IF NOT EXISTS runs_workflow ON runs (workflow);
+CREATE INDEX IF NOT EXISTS runs_num_tasks ON runs (num_tasks);
+CREATE INDEX IF NOT EXISTS parameters_name_value ON parameters (name, value, run_key);
+CREATE INDEX IF NOT EXISTS parameters_run ON parameters (run_key);
+CREATE INDEX IF NOT EXISTS hosts_run ON hosts (run_key);
+CREATE INDEX IF NOT EXISTS hosts_name ON hosts (host_name, run_key);
+CREATE INDEX IF NOT EXISTS tasks_run ON tasks (run_key);
+CREATE INDEX IF NOT EXISTS metrics_name ON metrics (name, run_key);
+CREATE INDEX IF NOT EXISTS metrics_run ON metrics (run_key);
+'''
+
+def connect(path):
+    connection = sqlite3.connect(path, timeout=60.0)
+    connection.execute('PRAGMA journal_mode=WAL')
+    connection.execute('PRAGMA synchronous=NORMAL')
+    connection.executescript(SCHEMA)
+    return connection
+
+
+def read_blocks(path, key, columns, constant=()):
+    """Yield the runs of a result file (lists of rows, with the given columns): a new run starts when the run ID
+    changes, when the key column repeats, or when one of the constant columns changes."""
+    path = pathlib.Path(path)
+    if not path.exists():
+        return
+    with open(path) as result_file:
+        reader = csv.reader(result_file)
+        header = next(reader, [])
+        run_id_index, key_index = header.index('run_id'), header.index(key)
+        indexes = [header.index(column) for column in columns]
+        constant_indexes = [header.index(column) for column in constant]
+        block, first, seen = [], None, set()
+        for row in reader:
+            if block and (row[run_id_index] != first[run_id_index] or row[key_index] in seen or
+                          any(row[index] != first[index] for index in constant_indexes)):
+                yield block
+                block, seen = [], set()
+            if not block:
+                first = row
+            block.append([row[index] for index in indexes])
+            seen.add(row[key_index])
+        if block:
+            yield block
+
+
+HOST_COLUMNS = ['run_id', 'host_name', 'num_of_cores', 'num_of_tasks', 'tasks_failed', 'completion_date', 'power']
+METRIC_COLUMNS = ['run_id', 'metric', 'value']
+
+
+def insert_run(connection, host_rows, metric_rows, platform, workflow, parameters):
+    """Insert a run (host rows of execution_output.csv, metric rows of execution_metrics.csv, as dicts) in one transaction."""
+    first = host_rows[0]
+    makespan = float(first['completion_date'])
+    hosts = [(row['host_name'], int(row['num_of_cores']), float(row['power']) * float(row['completion_date']),
+              float(row['power'])) for row in host_rows]
+    with connection:
+        run_key = connection.execute(
+            'INSERT INTO runs (run_id, created, platform, workflow, num_tasks, tasks_failed, makespan, energy) '
+            'VALUES (?, ?, ?, ?, ?, ?, ?, ?)',
+            (first['run_id'], time.time(), platform, workflow, int(first['num_of_tasks']), int(first['tasks_failed']),
+             makespan, sum(host[2] for host in hosts))).lastrowid
+        connection.executemany('INSERT INTO parameters VALUES (?, ?, ?)',
+                               [(run_key, name, value) for name, value in parameters.items()])
+        connection.executemany('INSERT INTO hosts VALUES (?, ?, ?, ?, ?)', [(run_key,) + host for host in hosts])
+        connection.executemany('INSERT INTO metrics VALUES (?, ?, ?)',
+                               [(run_key, row['metric'], float(row['value'])) for row in metric_rows])
+
+
+def import_directory(connection, directory, platform=None, workflow=None, parameters=None):
+    """Import the runs of CSV result files that were not imported yet (recorded as the csv_import parameter)."""
+    directory = pathlib.Path(directory)
+    output_file = (directory / 'execution_output.csv').resolve()
+    host_blocks = list(read_blocks(output_file, 'host_name', HOST_COLUMNS, ['completion_date']))
+    metric_blocks = list(read_blocks(directory / 'execution_metrics.csv', 'metric', METRIC_COLUMNS))
+    if metric_blocks and (len(metric_blocks) != len(host_blocks) or
+                          any(hosts[0][0] != metrics[0][0] for hosts, metrics in zip(host_blocks, metric_blocks))):
+        print(f'{directory}: the {len(metric_blocks)} metric blocks do not match the {len(host_blocks)} runs, '
+              f'the metrics are not imported')
+        metric_blocks = []
+    imported = {value for (value,) in connection.execute("SELECT value FROM parameters WHERE name = 'csv_import'")}
+    num_runs = 0
+    for i, host_rows in enumerate(host_blocks):
+        checksum = hashlib.sha1(repr(host_rows).encode()).hexdigest()
+        csv_import = f'{output_file}:{i}:{checksum}'
+        if csv_import in imported:
+            continue
+        insert_run(connection, [dict(zip(HOST_COLUMNS, row)) for row in host_rows],
+                   [dict(zip(METRIC_COLUMNS, row)) for row in metric_blocks[i]] if metric_blocks else [],
+                   platform, workflow, dict(parameters or {}, csv_import=csv_import))
+        num_runs += 1
+    return num_runs
+
+
+def import_queue(connection, queue, platform=None):
+    """Import the completed runs of a sweep queue that were not imported yet (recorded as the queue_run parameter)."""
+    queue = pathlib.Path(queue)
+    config = json.loads((queue / 'config.json').read_text())
+    # As recorded by the simulator: flags have an empty value
+    parameters = {argument[2:].partition('=')[0]: argument.partition('=')[2]
+                  for argument in config['simulator_args'] if argument.startswith('--')}
+    imported = {value for (value,) in connection.execute("SELECT value FROM parameters WHERE name = 'queue_run'")}
+    num_runs = 0
+    for entry in sorted((queue / 'done').iterdir()):
+        run, worker = entry.stem.split('@', 1)
+        queue_run = f'{queue.resolve()}:{run}'
+        if queue_run in imported:
+            continue
+        num_runs += import_directory(connection, queue / 'results' / worker / run, platform or config['platform'],
+                                     json.loads(entry.read_text())['recipe'], dict(parameters, queue_run=queue_run))
+    return num_runs
+
+
+def query(database, sql, output_path=None):
+    connection = sqlite3.connect(database, timeout=60.0)
+    start = time.perf_counter()
+    cursor = connection.execute(sql)
+    output = open(output_path, 'w', newline='') if output_path else sys.stdout
+    writer = csv.writer(output)
+    writer.writerow([column[0] for column in cursor.description or []])
+    num_rows = 0
+    while True:
+        rows = cursor.fetchmany(10000)
+        if not rows:
+            break
+        writer.writerows(rows)
+        num_rows += len(rows)
+    if output_path:
+        output.close()
+    print(f'{num_rows} rows in {1000 * (time.perf_counter() - start):.1f} ms', file=sys.stderr)
+
+
+# The block splitting is shared with src/compare_results.py, which imports this module
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Import simulation results into a SQLite database, and query it')
+    subparsers = parser.add_subparsers(dest='command', required=True)
+    import_parser = subparsers.add_parser('import', help='import CSV result files')
+    import_parser.add_argument('database', help='SQLite database file (created if needed)')
+    import_parser.add_argument('directories', nargs='*',
+                               help='directories of execution_output.csv and execution_metrics.csv (runs already imported are skipped)')
+    import_parser.add_argument('--queue', help='sweep queue whose completed runs are imported (once each)')
+    import_parser.add_argument('--platform', help='platform of the imported runs (default: the one of the queue, if any)')
+    query_parser = subparsers.add_parser('query', help='run an SQL query and print its rows as CSV')
+    query_parser.add_argument('database', help='SQLite database file')
+    query_parser.add_argument('sql', help='SQL query')
+    query_parser.add_argument('--output', help='CSV file of the rows (default: standard output)')
+    args = parser.parse_args()
+
+    if args.command == 'import':
+        connection = connect(args.database)
+        num_runs = sum(import_directory(connection, directory, args.platform) for directory in args.directories)
+        if args.queue:
+            num_runs += import_queue(connection, args.queue, args.platform)
+        connection.execute('ANALYZE')
+        connection.close()
+        print(f'Imported {num_runs} runs into {args.database}')
+    else:
+        query(args.database, args.sql, args.output)
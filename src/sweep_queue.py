@@ -0,0 +1,298 @@
+import argparse
+import json
+import os
+import pathlib
+import shlex
+import shutil
+import socket
+import subprocess
+import sys
+import threading
+import time
+
+# File-based work queue for running a sweep on several machines that share a filesystem (e.g., an NFS
+# mount), without any other service: every state change is an atomic rename within the queue directory.
+#
+#   <queue>/config.json                      simulator, platform and options of the sweep (paths within the
+#                                            repository are relative to it, and resolved in each worker's checkout)
+#   <queue>/pending/<run>.json               runs to do (the recipe to simulate)
+#   <queue>/claimed/<run>@<worker>.json      runs being simulated, leased by a worker
+#   <queue>/done/<run>@<worker>.json         completed runs, and the worker whose results count
+#   <queue>/failed/<run>@<worker>.json       runs whose simulation failed
+#   <queue>/results/<worker>/<run>/          result files of each run (the --output-dir of the simulator)
+#   <queue>/merged/<run>                     runs whose results were merged
+#   <queue>/merged/<run>.pending             run being merged, with the sizes of the result files before it
+#   <queue>/clock/<worker>                   file each worker touches to read the date of the shared filesystem
+#
+# A worker claims a run by renaming it from pending/ to claimed/ (only one rename succeeds), and renews
+# its lease by touching the claimed file while the simulation runs. A claim whose file was not touched for
+# longer than the lease (the worker died or lost the mount) is put back into pending/ by the next worker
+# that looks for work (the age of a claim is measured against a file the worker touches on the same
+# filesystem, so that the clocks of the machines do not need to agree); if the old worker is still alive, it notices that its claim is gone, stops its
+# simulation and drops its results. Each run writes its results to its own directory, so a partial run
+# never reaches the merged files, and a merge interrupted by a crash is rolled back by the next one.
+#
+#   python3 src/sweep_queue.py init /shared/sweep --platform platforms/apollo_2000_platform.xml
+#   python3 src/sweep_queue.py work /shared/sweep        # on each machine, as many times as wanted
+#   python3 src/sweep_queue.py status /shared/sweep
+#   python3 src/sweep_queue.py merge /shared/sweep --output-dir datas
+
+ROOT = pathlib.Path(__file__).parent.parent
+STATES = ['pending', 'claimed', 'done', 'failed']
+
+parser = argparse.ArgumentParser(description='Run a sweep across machines with a work queue on a shared filesystem')
+subparsers = parser.add_subparsers(dest='command', required=True)
+init_parser = subparsers.add_parser('init', help='create the queue with one run per recipe (no-op if it exists)')
+init_parser.add_argument('queue', help='queue directory, on the shared filesystem')
+init_parser.add_argument('--platform', default=str(ROOT / 'platforms' / 'apollo_2000_platform.xml'), help='XML platform file')
+init_parser.add_argument('--workflows', default=str(ROOT / 'workflows'), help='folder of the recipes (searched recursively)')
+init_parser.add_argument('--repository', help='packed recipe file, whose keys are the recipes (instead of --workflows)')
+init_parser.add_argument('--simulator', default=str(ROOT / 'build' / 'my-wrench-simulator'),
+                         help='simulator executable (if within the repository, each worker runs the one of its own checkout)')
+init_parser.add_argument('--commport-pool-size', type=int, default=20000, help='WRENCH commport pool size')
+init_parser.add_argument('--simulator-args', default='', help='extra simulator arguments (shell syntax)')
+work_parser = subparsers.add_parser('work', help='simulate pending runs until there are none left')
+work_parser.add_argument('queue', help='queue directory')
+work_parser.add_argument('--lease', type=float, default=600.0,
+                         help='seconds after which a claim that was not renewed is stale (renewed every quarter of it)')
+work_parser.add_argument('--worker-id', default=f'{socket.gethostname()}-{os.getpid()}', help='name of this worker')
+work_parser.add_argument('--max-runs', type=int, help='stop after this many runs')
+work_parser.add_argument('--simulator', help='simulator executable of this worker (default: the one of the queue)')
+merge_parser = subparsers.add_parser('merge', help='append the results of the completed runs to the result files')
+merge_parser.add_argument('queue', help='queue directory')
+merge_parser.add_argument('--output-dir', default=str(ROOT / 'datas'), help='directory of the merged result files')
+status_parser = subparsers.add_parser('status', help='count the runs in each state')
+status_parser.add_argument('queue', help='queue directory')
+requeue_parser = subparsers.add_parser('requeue-failed', help='put the failed runs back into the pending runs')
+requeue_parser.add_argument('queue', help='queue directory')
+args = parser.parse_args()
+
+queue = pathlib.Path(args.queue)
+
+
+def run_name(path):
+    """The run of a queue entry, e.g. 000042 for claimed/000042@host-123.json."""
+    return path.stem.split('@')[0]
+
+
+def worker_name(path):
+    return path.stem.split('@', 1)[1]
+
+
+def portable(path):
+    """A path as stored in the queue: relative to the repository if it is within it, so that it does not depend
+    on where each machine has its checkout."""
+    path = pathlib.Path(path).resolve()
+    try:
+        return str(path.relative_to(ROOT.resolve()))
+    except ValueError:
+        return str(path)
+
+
+def local(path):
+    """A path stored in the queue, in the checkout of this worker."""
+    return str(ROOT / path) if not pathlib.Path(path).is_absolute() else path
+
+
+def filesystem_now(name):
+    """The current date of the shared filesystem, which stamps the lease renewals (rather than the clock of
+    this machine, which may be skewed)."""
+    clock = queue / 'clock' / name
+    clock.parent.mkdir(exist_ok=True)
+    clock.touch()
+    return clock.stat().st_mtime
+
+
+def list_recipes():
+    if args.repository:
+        listing = subprocess.run([sys.executable, str(ROOT / 'src' / 'wfpackrecipes.py'), '--list', args.repository],
+                                 check=True, capture_output=True, text=True).stdout
+        return [key for key in listing.splitlines() if key]
+    return sorted(str(path) for path in pathlib.Path(args.workflows).rglob('*.json'))
+
+
+def init():
+    if queue.exists():
+        print(f'Queue {queue} already exists: joining it')
+        return
+    # The queue is built aside and renamed into place, so that concurrent inits create it once
+    staging = queue.with_name(f'{queue.name}.init-{socket.gethostname()}-{os.getpid()}')
+    for state in STATES + ['results', 'merged', 'clock']:
+        (staging / state).mkdir(parents=True)
+    recipes = list_recipes()
+    for index, recipe in enumerate(recipes):
+        (staging / 'pending' / f'{index:06d}.json').write_text(
+            json.dumps({'recipe': recipe if args.repository else portable(recipe)}))
+    config = {'simulator': portable(args.simulator), 'platform': portable(args.platform),
+              'commport_pool_size': args.commport_pool_size, 'simulator_args': shlex.split(args.simulator_args),
+              'recipe_keys': bool(args.repository)}
+    (staging / 'config.json').write_text(json.dumps(config, indent=2))
+    try:
+        os.rename(staging, queue)
+    except OSError:
+        shutil.rmtree(staging)
+        print(f'Queue {queue} was created concurrently: joining it')
+        return
+    print(f'Queue {queue} created with {len(recipes)} runs')
+
+
+def reclaim_stale_claims(lease, worker):
+    """Put the claims that were not renewed for longer than the lease back into the pending runs."""
+    now = filesystem_now(worker)
+    for claim in (queue / 'claimed').iterdir():
+        try:
+            if now - claim.stat().st_mtime > lease:
+                os.rename(claim, queue / 'pending' / f'{run_name(claim)}.json')
+                print(f'Reclaimed run {run_name(claim)} from stale worker {worker_name(claim)}')
+        except FileNotFoundError:
+            # Completed, renewed away or reclaimed by another worker in the meantime
+            pass
+
+
+def claim_run(worker):
+    for entry in sorted((queue / 'pending').iterdir()):
+        claim = queue / 'claimed' / f'{run_name(entry)}@{worker}.json'
+        try:
+            os.rename(entry, claim)
+        except FileNotFoundError:
+            continue
+        # The lease starts now, whatever the date of the pending file
+        os.utime(claim)
+        return claim
+    return None
+
+
+def simulate(claim, config, worker, lease):
+    """Run the simulation of a claimed run while renewing its lease; returns its exit code, or None if the lease was lost."""
+    output_dir = queue / 'results' / worker / run_name(claim)
+    shutil.rmtree(output_dir, ignore_errors=True)
+    output_dir.mkdir(parents=True)
+    recipe = json.loads(claim.read_text())['recipe']
+    if not config.get('recipe_keys'):
+        recipe = local(recipe)
+    command = [args.simulator or local(config['simulator']), f"--wrench-commport-pool-size={config['commport_pool_size']}",
+               local(config['platform']),
+               recipe, '--wrench-energy-simulation', f'--output-dir={output_dir}'] + config['simulator_args']
+    with open(output_dir / 'simulator.log', 'w') as log:
+        try:
+            process = subprocess.Popen(command, stdout=log, stderr=subprocess.STDOUT)
+        except OSError as e:
+            log.write(f'Cannot run the simulator: {e}\n')
+            return 127
+        finished = threading.Event()
+        lost = threading.Event()
+
+        def renew():
+            while not finished.wait(lease / 4):
+                try:
+                    os.utime(claim)
+                except FileNotFoundError:
+                    lost.set()
+                    process.kill()
+                    return
+
+        renewer = threading.Thread(target=renew, daemon=True)
+        renewer.start()
+        exit_code = process.wait()
+        finished.set()
+        renewer.join()
+    return None if lost.is_set() else exit_code
+
+
+def work():
+    config = json.loads((queue / 'config.json').read_text())
+    worker = args.worker_id.replace('@', '_')
+    num_runs = 0
+    while args.max_runs is None or num_runs < args.max_runs:
+        reclaim_stale_claims(args.lease, worker)
+        claim = claim_run(worker)
+        if claim is None:
+            if any((queue / 'claimed').iterdir()):
+                # Other workers may die before completing their runs
+                time.sleep(min(args.lease / 4, 60.0))
+                continue
+            break
+        print(f'Worker {worker}: simulating run {run_name(claim)}')
+        exit_code = simulate(claim, config, worker, args.lease)
+        num_runs += 1
+        state = 'done' if exit_code == 0 else 'failed'
+        try:
+            os.rename(claim, queue / state / claim.name)
+        except FileNotFoundError:
+            exit_code = None
+        if exit_code is None:
+            print(f'Worker {worker}: lost the lease of run {run_name(claim)}, its results are dropped')
+            shutil.rmtree(queue / 'results' / worker / run_name(claim), ignore_errors=True)
+        elif exit_code != 0:
+            print(f'Worker {worker}: run {run_name(claim)} failed with exit code {exit_code}')
+    print(f'Worker {worker}: stopping after {num_runs} runs')
+
+
+def rollback_merges():
+    """Truncate the result files to their size before the runs whose merge was interrupted, which are merged again."""
+    for pending in (queue / 'merged').glob('*.pending'):
+        record = json.loads(pending.read_text())
+        for name, size in record['sizes'].items():
+            target = pathlib.Path(record['output_dir']) / name
+            if target.exists() and target.stat().st_size > size:
+                os.truncate(target, size)
+        pending.unlink()
+        print(f'Rolled back the interrupted merge of run {pending.stem}')
+
+
+def merge():
+    output_dir = pathlib.Path(args.output_dir)
+    output_dir.mkdir(parents=True, exist_ok=True)
+    rollback_merges()
+    num_merged = 0
+    for entry in sorted((queue / 'done').iterdir()):
+        marker = queue / 'merged' / run_name(entry)
+        if marker.exists():
+            continue
+        results = sorted((queue / 'results' / worker_name(entry) / run_name(entry)).glob('*.csv'))
+        # The sizes of the result files are recorded before appending, and the record becomes the marker of the
+        # run once all its rows are appended: a crash in between leaves a record to roll back, not duplicates
+        sizes = {result.name: (output_dir / result.name).stat().st_size if (output_dir / result.name).exists() else 0
+                 for result in results}
+        pending = marker.with_name(marker.name + '.pending')
+        staging = marker.with_name(marker.name + '.staging')
+        staging.write_text(json.dumps({'output_dir': str(output_dir.resolve()), 'sizes': sizes}))
+        os.rename(staging, pending)
+        for result in results:
+            target = output_dir / result.name
+            with open(result) as source, open(target, 'a') as destination:
+                header = source.readline()
+                if sizes[result.name] == 0:
+                    destination.write(header)
+                shutil.copyfileobj(source, destination)
+                destination.flush()
+                os.fsync(destination.fileno())
+        os.rename(pending, marker)
+        num_merged += 1
+    pending = sum(1 for state in ['pending', 'claimed'] for _ in (queue / state).iterdir())
+    print(f'Merged the results of {num_merged} runs into {output_dir}' + (f' ({pending} runs not completed yet)' if pending else ''))
+
+
+def status():
+    counts = {state: sum(1 for _ in (queue / state).iterdir()) for state in STATES}
+    print(', '.join(f'{count} {state}' for state, count in counts.items()))
+    now = filesystem_now(f'status-{socket.gethostname()}-{os.getpid()}')
+    (queue / 'clock' / f'status-{socket.gethostname()}-{os.getpid()}').unlink()
+    for claim in sorted((queue / 'claimed').iterdir()):
+        print(f'  run {run_name(claim)}: {worker_name(claim)}, lease renewed {now - claim.stat().st_mtime:.0f} s ago')
+    for failure in sorted((queue / 'failed').iterdir()):
+        print(f'  run {run_name(failure)} failed on {worker_name(failure)}: {json.loads(failure.read_text())["recipe"]}')
+
+
+def requeue_failed():
+    num_runs = 0
+    for failure in sorted((queue / 'failed').iterdir()):
+        try:
+            os.rename(failure, queue / 'pending' / f'{run_name(failure)}.json')
+            num_runs += 1
+        except FileNotFoundError:
+            pass
+    print(f'{num_runs} failed runs are pending again')
+
+
+{'init': init, 'work': work, 'merge': merge, 'status': status, 'requeue-failed': requeue_failed}[args.command]()
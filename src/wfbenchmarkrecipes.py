@@ -0,0 +1,23 @@
+import pathlib
+from wfcommons.wfchef.recipes import BlastRecipe
+from wfcommons import WorkflowGenerator
+
+# Large recipes used to benchmark the workflow loaders (wfformat-loader-benchmark);
+# they are kept out of workflows/ so that start.sh does not simulate them
+TASK_COUNTS = [1000, 10000, 100000]
+
+output_dir = pathlib.Path(__file__).parent.parent / 'benchmarks' / 'recipes'
+output_dir.mkdir(parents=True, exist_ok=True)
+
+for amount_tasks in TASK_COUNTS:
+    generator = WorkflowGenerator(BlastRecipe.from_num_tasks(amount_tasks))
+    workflow = generator.build_workflows(1)[0]
+    output_path = output_dir / f'blast-workflow-{amount_tasks}.json'
+    try:
+        workflow.write_json(output_path)
+        print(f"Created {output_path}")
+    except Exception as e:
+        print(f"Error writing {output_path}: {e}")
+
+
+print("Done!!")
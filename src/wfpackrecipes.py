@@ -0,0 +1,146 @@
+import argparse
+import json
+import pathlib
+import re
+import struct
+import sys
+from array import array
+
+# Packs the WfFormat 1.5 recipes of workflows/ into a single memory-mappable repository file,
+# read by the simulator with --recipe-repository=<file> (see include/RecipeRepository.h).
+#
+# Layout (little-endian, every section 8-byte aligned):
+#   header:  magic "WFPACK02", u64 number of entries, u64 offset of the index, u64 offset of the family names
+#   recipes: one block per recipe (see pack_recipe)
+#   index:   per entry u64 block offset, u64 block length, u32 number of tasks, u32 seed,
+#            u32 family name offset (relative to the family names), u32 family name length
+#   family names
+#
+# Recipes are looked up by key <family>/<number of tasks>/<seed>, where the seed is the index
+# at the end of the recipe file name (e.g. blast-workflow-100-0.json).
+
+MAGIC = b'WFPACK02'
+HEADER = struct.Struct('<8sQQQ')
+INDEX_ENTRY = struct.Struct('<QQIIII')
+RECIPE_HEADER = struct.Struct('<IIIIII')
+
+parser = argparse.ArgumentParser(description='Pack WfFormat recipes into a memory-mappable repository file')
+parser.add_argument('--workflows', default=str(pathlib.Path(__file__).parent.parent / 'workflows'),
+                    help='directory searched recursively for recipes')
+parser.add_argument('--output', default=str(pathlib.Path(__file__).parent.parent / 'workflows' / 'recipes.wfpack'),
+                    help='path of the repository file')
+parser.add_argument('--list', metavar='REPOSITORY', help='print the keys of an existing repository file and exit')
+args = parser.parse_args()
+
+
+def pad(data):
+    data.extend(b'\0' * (-len(data) % 8))
+
+
+def pack_recipe(recipe):
+    """
+    Recipe block: u32 numbers of tasks, files, input references, output references, dependencies and
+    string bytes, then f64 task runtimes, average CPU (-1 if unknown), read bytes (-1), written bytes (-1)
+    and memory, u64 file sizes, u32 task core counts (coreCount, 1 if unknown), task ID offsets (n+1), file ID offsets (n+1), input offsets (n+1),
+    inputs, output offsets (n+1), outputs, dependency parents, dependency children, and the ID strings.
+    """
+    specification = recipe['workflow']['specification']
+    executions = {task['id']: task for task in recipe['workflow']['execution']['tasks']}
+    tasks = specification['tasks']
+    files = specification['files']
+    task_indices = {task['id']: i for i, task in enumerate(tasks)}
+    file_indices = {file['id']: i for i, file in enumerate(files)}
+
+    strings = bytearray()
+    task_id_offsets, file_id_offsets = array('I', [0]), array('I', [0])
+    for task in tasks:
+        strings += task['id'].encode()
+        task_id_offsets.append(len(strings))
+    for file in files:
+        strings += file['id'].encode()
+        file_id_offsets.append(len(strings))
+
+    input_offsets, inputs = array('I', [0]), array('I')
+    output_offsets, outputs = array('I', [0]), array('I')
+    parents, children = array('I'), array('I')
+    for i, task in enumerate(tasks):
+        inputs.extend(file_indices[f] for f in task.get('inputFiles', []))
+        input_offsets.append(len(inputs))
+        outputs.extend(file_indices[f] for f in task.get('outputFiles', []))
+        output_offsets.append(len(outputs))
+        for parent in task.get('parents', []):
+            parents.append(task_indices[parent])
+            children.append(i)
+
+    block = bytearray(RECIPE_HEADER.pack(len(tasks), len(files), len(inputs), len(outputs), len(parents), len(strings)))
+    pad(block)
+    for field, default in (('runtimeInSeconds', 0.0), ('avgCPU', -1.0), ('readBytes', -1.0),
+                           ('writtenBytes', -1.0), ('memoryInBytes', 0.0)):
+        block += array('d', (float(executions.get(task['id'], {}).get(field, default)) for task in tasks)).tobytes()
+    block += array('Q', (int(file.get('sizeInBytes', 0)) for file in files)).tobytes()
+    block += array('I', (max(int(executions.get(task['id'], {}).get('coreCount', 1)), 1) for task in tasks)).tobytes()
+    for section in (task_id_offsets, file_id_offsets, input_offsets, inputs, output_offsets, outputs, parents, children):
+        block += section.tobytes()
+    block += strings
+    pad(block)
+    return block
+
+
+def list_keys(path):
+    data = pathlib.Path(path).read_bytes()
+    magic, num_entries, index_offset, names_offset = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        sys.exit(f'{path} is not a recipe repository')
+    for i in range(num_entries):
+        _, _, num_tasks, seed, name_offset, name_length = INDEX_ENTRY.unpack_from(data, index_offset + i * INDEX_ENTRY.size)
+        family = data[names_offset + name_offset:names_offset + name_offset + name_length].decode()
+        print(f'{family}/{num_tasks}/{seed}')
+
+
+if args.list:
+    list_keys(args.list)
+    exit(0)
+
+if sys.byteorder != 'little':
+    sys.exit('The repository format is little-endian')
+
+output = bytearray(HEADER.size)
+entries = []
+keys = set()
+families = bytearray()
+family_offsets = {}
+for recipe_path in sorted(pathlib.Path(args.workflows).rglob('*.json')):
+    with open(recipe_path) as recipe_file:
+        recipe = json.load(recipe_file)
+    if recipe.get('schemaVersion') != '1.5':
+        print(f'Skipping {recipe_path}: unsupported WfFormat version {recipe.get("schemaVersion")}')
+        continue
+    family = recipe_path.parent.name
+    num_tasks = len(recipe['workflow']['specification']['tasks'])
+    match = re.search(r'-(\d+)\.json$', recipe_path.name)
+    seed = int(match.group(1)) if match else 0
+    key = f'{family}/{num_tasks}/{seed}'
+    if key in keys:
+        sys.exit(f'Duplicate recipe key {key} ({recipe_path})')
+    keys.add(key)
+    if family not in family_offsets:
+        family_offsets[family] = len(families)
+        families += family.encode()
+
+    block = pack_recipe(recipe)
+    entries.append((len(output), len(block), num_tasks, seed, family_offsets[family], len(family.encode())))
+    output += block
+    print(f'Packed {key}')
+
+index_offset = len(output)
+for entry in entries:
+    output += INDEX_ENTRY.pack(*entry)
+names_offset = len(output)
+output += families
+HEADER.pack_into(output, 0, MAGIC, len(entries), index_offset, names_offset)
+
+# Written next to the destination and renamed, so that running simulations keep their mapping
+temporary_path = pathlib.Path(args.output + '.tmp')
+temporary_path.write_bytes(output)
+temporary_path.replace(args.output)
+print(f'Packed {len(entries)} recipes into {args.output} ({len(output)} bytes)')
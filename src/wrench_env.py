@@ -0,0 +1,224 @@
+import argparse
+import os
+import pathlib
+import random
+import shutil
+import struct
+import subprocess
+import tempfile
+import time
+
+import numpy as np
+
+# Gym-style environments around the simulator, for training learned schedulers: the simulator is run with
+# --policy-fds and pauses at each scheduling decision of the WMS, sends an observation (ready tasks, compute
+# service slots, host power states) as flat arrays and waits for an action, i.e., a service slot (or -1 to
+# defer) for each ready task (see include/PolicyChannel.h for the protocol).
+#
+#   from wrench_env import SchedulingEnv, VectorSchedulingEnv
+#   env = VectorSchedulingEnv(8, platform='platforms/apollo_2000_platform.xml', workflows=['workflows/blast/...json'])
+#   observations = env.reset()
+#   observations, rewards, dones, infos = env.step(actions)  # actions: (num_envs, max ready tasks) slots, -1 padded
+#
+# Each environment is a simulator process, so the environments of a VectorSchedulingEnv simulate in parallel
+# between two steps. Rewards are minus the energy consumed (J) times energy_weight, minus the simulated time
+# elapsed (s) times time_weight, since the previous decision.
+
+ROOT = pathlib.Path(__file__).parent.parent
+
+OBSERVATION = 0
+END_OF_EPISODE = 1
+
+TASK_ARRAYS = ['task_predicted_runtimes', 'task_flops', 'task_io_bytes', 'task_categories', 'task_num_children']
+SERVICE_ARRAYS = ['service_idle_cores', 'service_total_cores', 'service_speeds', 'service_idle_watts',
+                  'service_all_cores_watts', 'service_accelerators']
+HOST_ARRAYS = ['host_pstates', 'host_powered_down']
+
+
+def read_exactly(fd, size):
+    chunks = []
+    while size > 0:
+        chunk = os.read(fd, size)
+        if not chunk:
+            raise EOFError('the simulator exited before the end of the episode')
+        chunks.append(chunk)
+        size -= len(chunk)
+    return b''.join(chunks)
+
+
+class SchedulingEnv:
+    """A single environment, i.e., a simulator process per episode."""
+
+    def __init__(self, platform, workflows, simulator=str(ROOT / 'build' / 'my-wrench-simulator'), simulator_args=(),
+                 energy_weight=1.0, time_weight=0.0, seed=None):
+        self.platform = platform
+        self.workflows = list(workflows)
+        self.simulator = simulator
+        self.simulator_args = list(simulator_args)
+        self.energy_weight = energy_weight
+        self.time_weight = time_weight
+        self.rng = random.Random(seed)
+        self.process = None
+        self.output_dir = None
+        self.last = None
+        self.num_ready_tasks = 0
+
+    def reset(self):
+        """Start an episode on a workflow drawn from the workflows, and return its first observation."""
+        self.close()
+        action_read, self.action_write = os.pipe()
+        self.observation_read, observation_write = os.pipe()
+        # Result files of concurrent environments must not be interleaved
+        self.output_dir = tempfile.mkdtemp(prefix='wrench-env-')
+        self.process = subprocess.Popen(
+            [self.simulator, '--wrench-commport-pool-size=20000', self.platform, self.rng.choice(self.workflows),
+             '--wrench-energy-simulation', f'--policy-fds={action_read},{observation_write}',
+             f'--output-dir={self.output_dir}'] + self.simulator_args,
+            pass_fds=(action_read, observation_write), stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        os.close(action_read)
+        os.close(observation_write)
+        observation, done = self.receive()
+        self.last = observation
+        if done:
+            raise RuntimeError('the episode ended without any scheduling decision')
+        return observation
+
+    def send(self, action):
+        """Send the service slot (or -1) of each ready task of the last observation."""
+        action = np.asarray(action, dtype='<i4')[:self.num_ready_tasks]
+        if len(action) != self.num_ready_tasks:
+            raise ValueError(f'expected {self.num_ready_tasks} actions, got {len(action)}')
+        os.write(self.action_write, struct.pack('<I', len(action)) + action.tobytes())
+
+    def receive(self):
+        """Read the next observation; return it and whether the episode is over."""
+        message_type, num_tasks, num_services, num_hosts = struct.unpack('<4I', read_exactly(self.observation_read, 16))
+        date, energy = struct.unpack('<2d', read_exactly(self.observation_read, 16))
+        sizes = [num_tasks] * len(TASK_ARRAYS) + [num_services] * len(SERVICE_ARRAYS) + [num_hosts] * len(HOST_ARRAYS)
+        values = np.frombuffer(read_exactly(self.observation_read, 8 * sum(sizes)), dtype='<f8')
+        observation = {'date': date, 'energy': energy}
+        offset = 0
+        for name, size in zip(TASK_ARRAYS + SERVICE_ARRAYS + HOST_ARRAYS, sizes):
+            observation[name] = values[offset:offset + size]
+            offset += size
+        observation['task_indices'] = np.frombuffer(read_exactly(self.observation_read, 4 * num_tasks), dtype='<u4')
+        self.num_ready_tasks = num_tasks
+        return observation, message_type == END_OF_EPISODE
+
+    def reward(self, observation):
+        return -(self.energy_weight * (observation['energy'] - self.last['energy']) +
+                 self.time_weight * (observation['date'] - self.last['date']))
+
+    def step(self, action):
+        """Apply an action; return the next observation, the reward, whether the episode is over, and info."""
+        self.send(action)
+        return self.collect()
+
+    def collect(self):
+        observation, done = self.receive()
+        reward = self.reward(observation)
+        self.last = observation
+        info = {}
+        if done:
+            info = {'makespan': observation['date'], 'energy': observation['energy'], 'exit_code': self.process.wait()}
+            self.close()
+        return observation, reward, done, info
+
+    def close(self):
+        if self.process is not None:
+            os.close(self.action_write)
+            os.close(self.observation_read)
+            if self.process.poll() is None:
+                self.process.kill()
+            self.process.wait()
+            self.process = None
+        if self.output_dir is not None:
+            shutil.rmtree(self.output_dir, ignore_errors=True)
+            self.output_dir = None
+
+
+class VectorSchedulingEnv:
+    """Independent environments stepped together, with batched observations; finished episodes restart
+    automatically (the final observation of an episode is in its info, under 'final_observation')."""
+
+    def __init__(self, num_envs, seed=0, **kwargs):
+        self.envs = [SchedulingEnv(seed=seed + i, **kwargs) for i in range(num_envs)]
+
+    def reset(self):
+        return self.batch([env.reset() for env in self.envs])
+
+    def step(self, actions):
+        # All the actions are sent before any observation is read, so that the simulators run in parallel
+        for env, action in zip(self.envs, actions):
+            env.send(action)
+        observations, rewards, dones, infos = [], [], [], []
+        for env in self.envs:
+            observation, reward, done, info = env.collect()
+            if done:
+                info['final_observation'] = observation
+                observation = env.reset()
+            observations.append(observation)
+            rewards.append(reward)
+            dones.append(done)
+            infos.append(info)
+        return self.batch(observations), np.array(rewards), np.array(dones), infos
+
+    @staticmethod
+    def batch(observations):
+        """Stack observations; task arrays are padded to the largest number of ready tasks, with a mask."""
+        max_tasks = max(len(o['task_indices']) for o in observations)
+        batch = {'date': np.array([o['date'] for o in observations]),
+                 'energy': np.array([o['energy'] for o in observations]),
+                 'task_mask': np.zeros((len(observations), max_tasks), dtype=bool)}
+        for name in TASK_ARRAYS + ['task_indices']:
+            batch[name] = np.zeros((len(observations), max_tasks), dtype=observations[0][name].dtype)
+        for i, o in enumerate(observations):
+            num_tasks = len(o['task_indices'])
+            batch['task_mask'][i, :num_tasks] = True
+            for name in TASK_ARRAYS + ['task_indices']:
+                batch[name][i, :num_tasks] = o[name]
+        for name in SERVICE_ARRAYS + HOST_ARRAYS:
+            batch[name] = np.stack([o[name] for o in observations])
+        return batch
+
+    def close(self):
+        for env in self.envs:
+            env.close()
+
+
+def first_fit(batch):
+    """A baseline policy: each ready task goes to the first CPU service slot with an idle core."""
+    actions = np.full(batch['task_mask'].shape, -1, dtype='<i4')
+    idle_cores = batch['service_idle_cores'] * (1 - batch['service_accelerators'])
+    for i in range(len(actions)):
+        idle = idle_cores[i].copy()
+        for t in np.flatnonzero(batch['task_mask'][i]):
+            slots = np.flatnonzero(idle > 0)
+            if len(slots) == 0:
+                break
+            actions[i, t] = slots[0]
+            idle[slots[0]] -= 1
+    return actions
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Measure the decision throughput of parallel scheduling environments '
+                                                 'with a first-fit policy')
+    parser.add_argument('workflows', nargs='+', help='workflow files the episodes are drawn from')
+    parser.add_argument('--platform', default=str(ROOT / 'platforms' / 'apollo_2000_platform.xml'))
+    parser.add_argument('--simulator', default=str(ROOT / 'build' / 'my-wrench-simulator'))
+    parser.add_argument('--envs', type=int, default=os.cpu_count(), help='number of parallel environments')
+    parser.add_argument('--steps', type=int, default=1000, help='number of batched steps')
+    args = parser.parse_args()
+
+    env = VectorSchedulingEnv(args.envs, platform=args.platform, workflows=args.workflows, simulator=args.simulator)
+    batch = env.reset()
+    start = time.perf_counter()
+    episodes = 0
+    for _ in range(args.steps):
+        batch, rewards, dones, infos = env.step(first_fit(batch))
+        episodes += int(dones.sum())
+    elapsed = time.perf_counter() - start
+    env.close()
+    print(f'{args.steps * args.envs} decisions in {elapsed:.2f} s ({3600 * args.steps * args.envs / elapsed:.0f} decisions/hour), '
+          f'{episodes} episodes completed')
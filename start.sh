@@ -39,25 +39,220 @@
 
 #!/usr/bin/env bash
 
+# Uso: ./start.sh [--resume] [--repository] [--profile] [--commport-pool-size=<n>] [--context-threads=<n|auto>] [--queue=<dir>]
+#               [--results-db=<arquivo>]
+#   --resume      pula os recipes já concluídos segundo o journal e executa novamente os que falharam
+#                 ou foram interrompidos
+#   --repository  empacota os recipes em um único arquivo mapeado em memória (workflows/recipes.wfpack)
+#                 e executa cada recipe pela sua chave <família>/<número de tarefas>/<seed>
+#   --profile     registra os contadores de taxa de simulação (atores, mensagens, atividades pendentes,
+#                 tempo no WMS) em datas/execution_metrics.csv
+#   --commport-pool-size=<n>  tamanho do pool de commports do WRENCH (padrão 20000); use o máximo de
+#                 sim_max_pending_comms das execuções com --profile como referência
+#   --queue=<dir> usa uma fila de trabalho em um sistema de arquivos compartilhado (src/sweep_queue.py):
+#                 a primeira máquina cria a fila e todas as máquinas que executam o mesmo comando puxam
+#                 recipes dela; os resultados são consolidados com src/sweep_queue.py merge <dir>
+#   --context-threads=<n|auto>  número de threads que executam os atores do SimGrid em paralelo
+#                 (padrão: sequencial); verifique antes o determinismo com src/check_parallel_contexts.py
+#   --results-db=<arquivo>  insere também cada execução em um banco SQLite (src/results_db.py); com --queue,
+#                 importe os resultados da fila depois com src/results_db.py import <arquivo> --queue <dir>
+
 platform="platforms/apollo_2000_platform.xml"
 workflow_dir="workflows"
+results_dir="datas"
+# Cada execução escreve os seus resultados em um diretório próprio, anexados a $results_dir só se ela concluir
+runs_dir="$results_dir/runs"
+repository_file="$workflow_dir/recipes.wfpack"
+
+# Journal append-only da varredura: uma linha por evento, separada por tabulações
+#   data  run_id (recipe)  status (started|merging|completed|failed)  hash das entradas  tamanhos  código de saída
+# onde os tamanhos (<arquivo>=<bytes>,...) são os dos arquivos de resultados antes da consolidação da execução
+journal="datas/sweep_journal.tsv"
+# O journal é sincronizado com o disco (fsync) a cada journal_sync_batch eventos e ao sair
+journal_sync_batch=10
+journal_pending=0
+
+resume=0
+use_repository=0
+profile=0
+commport_pool_size=20000
+context_threads=""
+queue_dir=""
+results_db=""
+for arg in "$@"; do
+    case "$arg" in
+        --resume) resume=1 ;;
+        --repository) use_repository=1 ;;
+        --profile) profile=1 ;;
+        --commport-pool-size=*) commport_pool_size="${arg#*=}" ;;
+        --context-threads=*) context_threads="${arg#*=}" ;;
+        --queue=*) queue_dir="${arg#*=}" ;;
+        --results-db=*) results_db="${arg#*=}" ;;
+        *)
+            echo "Opção desconhecida: $arg"
+            exit 1
+            ;;
+    esac
+done
+
+mkdir -p "$(dirname "$journal")"
+touch "$journal"
+
+journal_sync() {
+    sync "$journal"
+    journal_pending=0
+}
+
+journal_append() {
+    printf '%s\t%s\t%s\t%s\t%s\t%s\n' "$(date +%s)" "$1" "$2" "$3" "$4" "$5" >> "$journal"
+    journal_pending=$((journal_pending + 1))
+    if [ "$journal_pending" -ge "$journal_sync_batch" ]; then
+        journal_sync
+    fi
+}
+
+trap journal_sync EXIT
+
+# Hash das entradas de uma execução: simulador, plataforma e recipe (ou repositório e chave)
+inputs_hash() {
+    if [ "$use_repository" -eq 1 ]; then
+        { cat ./build/my-wrench-simulator "$platform" "$repository_file" 2>/dev/null; echo "$1"; } | sha256sum | cut -c1-16
+    else
+        cat ./build/my-wrench-simulator "$platform" "$1" 2>/dev/null | sha256sum | cut -c1-16
+    fi
+}
+
+# Anexa os resultados de uma execução aos arquivos de $results_dir (o cabeçalho só em um arquivo novo). Os tamanhos
+# dos arquivos são registrados antes (status merging) e sincronizados, para que uma consolidação interrompida seja
+# desfeita por rollback_merge em vez de deixar linhas parciais ou duplicadas
+merge_results() {
+    local run_id="$1" hash="$2" run_dir="$3" result target sizes=""
+    for result in "$run_dir"/*.csv; do
+        [ -f "$result" ] || continue
+        target="$results_dir/$(basename "$result")"
+        sizes+="${sizes:+,}$(basename "$result")=$(stat -c %s "$target" 2>/dev/null || echo 0)"
+    done
+    journal_append "$run_id" "merging" "$hash" "$sizes" ""
+    journal_sync
+    for result in "$run_dir"/*.csv; do
+        [ -f "$result" ] || continue
+        target="$results_dir/$(basename "$result")"
+        if [ -s "$target" ]; then
+            tail -n +2 "$result" >> "$target"
+        else
+            cat "$result" > "$target"
+        fi
+        sync "$target"
+    done
+}
+
+# Trunca os arquivos de resultados aos tamanhos registrados antes de uma consolidação interrompida
+rollback_merge() {
+    local entries entry file size
+    IFS=',' read -r -a entries <<< "$1"
+    for entry in "${entries[@]}"; do
+        file="$results_dir/${entry%%=*}"
+        size="${entry#*=}"
+        if [ -f "$file" ] && [ "$(stat -c %s "$file")" -gt "$size" ]; then
+            truncate -s "$size" "$file"
+        fi
+    done
+}
+
+# Recipes já concluídos com as mesmas entradas (último status registrado para o run_id e o hash)
+declare -A completed
+# As execuções são sequenciais: só o último evento do journal pode ser uma consolidação interrompida
+IFS=$'\t' read -r timestamp run_id status hash sizes exit_code < <(tail -n 1 "$journal")
+if [ "$status" = "merging" ]; then
+    echo "Desfazendo a consolidação interrompida dos resultados de '$run_id'."
+    rollback_merge "$sizes"
+    journal_append "$run_id" "failed" "$hash" "" ""
+fi
+if [ "$resume" -eq 1 ]; then
+    while IFS=$'\t' read -r timestamp run_id status hash sizes exit_code; do
+        if [ "$status" = "completed" ]; then
+            completed["$run_id|$hash"]=1
+        else
+            unset 'completed["$run_id|$hash"]'
+        fi
+    done < "$journal"
+    echo "Retomando a varredura: ${#completed[@]} recipes já concluídos serão pulados."
+fi
+
+# Lista os recipes a executar, separados por caracteres nulos: caminhos dos arquivos .json ou chaves do repositório
+list_recipes() {
+    if [ "$use_repository" -eq 1 ]; then
+        python3 src/wfpackrecipes.py --list "$repository_file" | tr '\n' '\0'
+    else
+        find "$workflow_dir" -type f -name "*.json" -print0 | sort -z
+    fi
+}
+
+simulator_options=()
+if [ "$use_repository" -eq 1 ]; then
+    # O repositório é reconstruído se algum recipe (ou o formato do empacotador) for mais recente que ele
+    if [ ! -f "$repository_file" ] || [ src/wfpackrecipes.py -nt "$repository_file" ] || [ -n "$(find "$workflow_dir" -type f -name "*.json" -newer "$repository_file" -print -quit)" ]; then
+        echo "Empacotando os recipes em '$repository_file'..."
+        python3 src/wfpackrecipes.py --workflows "$workflow_dir" --output "$repository_file" > /dev/null || exit 1
+    fi
+    simulator_options+=("--recipe-repository=$repository_file")
+fi
+if [ "$profile" -eq 1 ]; then
+    simulator_options+=("--profile-simulation")
+fi
+if [ -n "$context_threads" ]; then
+    simulator_options+=("--context-threads=$context_threads")
+fi
+# O SQLite não é seguro em sistemas de arquivos de rede: com uma fila, o banco é preenchido depois pelo import
+if [ -n "$results_db" ] && [ -z "$queue_dir" ]; then
+    simulator_options+=("--results-db=$results_db")
+fi
+
+# Com uma fila compartilhada, o journal local não é usado: o estado de cada recipe é o diretório em que está na fila
+if [ -n "$queue_dir" ]; then
+    queue_options=(--platform "$platform" --workflows "$workflow_dir" --commport-pool-size "$commport_pool_size"
+                   "--simulator-args=${simulator_options[*]}")
+    if [ "$use_repository" -eq 1 ]; then
+        queue_options+=(--repository "$repository_file")
+    fi
+    python3 src/sweep_queue.py init "$queue_dir" "${queue_options[@]}" || exit 1
+    exec python3 src/sweep_queue.py work "$queue_dir"
+fi
 
 echo "Executando todos os arquivos .json encontrados recursivamente na pasta '$workflow_dir' em ordem alfabética:"
 
-find "$workflow_dir" -type f -name "*.json" -print0 | sort -z | while IFS= read -r -d $'\0' recipe_path; do
+while IFS= read -r -d $'\0' recipe_path; do
     recipe_file=$(basename "$recipe_path")
     recipe_dir=$(dirname "$recipe_path")
+    hash=$(inputs_hash "$recipe_path")
+
+    if [ -n "${completed["$recipe_path|$hash"]}" ]; then
+        echo "  - Pulando recipe já concluído: '$recipe_file' na pasta: '$recipe_dir'"
+        continue
+    fi
+
+    run_dir="$runs_dir/$(printf '%s' "$recipe_path" | sha256sum | cut -c1-16)"
+    rm -rf "$run_dir"
+    mkdir -p "$run_dir"
+    journal_append "$recipe_path" "started" "$hash" "" ""
 
     echo "  - Executando recipe: '$recipe_file' na pasta: '$recipe_dir'"
-    ./build/my-wrench-simulator --wrench-commport-pool-size=20000 "$platform" "$recipe_path" --wrench-energy-simulation
+    ./build/my-wrench-simulator --wrench-commport-pool-size="$commport_pool_size" "$platform" "$recipe_path" --wrench-energy-simulation \
+        "--output-dir=$run_dir" "${simulator_options[@]}"
+    exit_code=$?
 
-    if [ $? -ne 0 ]; then
+    if [ $exit_code -ne 0 ]; then
         echo "    Erro ao executar o recipe '$recipe_file' na pasta: '$recipe_dir'."
+        journal_append "$recipe_path" "failed" "$hash" "" "$exit_code"
+    else
+        merge_results "$recipe_path" "$hash" "$run_dir"
+        journal_append "$recipe_path" "completed" "$hash" "" "$exit_code"
+        rm -rf "$run_dir"
     fi
-done
+done < <(list_recipes)
 
 echo ""
 echo "------------------------------------------------------------------"
 echo "Fim da execução dos recipes encontrados recursivamente em '$workflow_dir'."
 
-exit 0
\ No newline at end of file
+exit 0